@@ -0,0 +1,218 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmarks of every engine on generated instances of the bundled domains.
+ *
+ * Benchmarks are named `<engine>/<domain>/<size>`. Besides Google Benchmark's timings each one reports:
+ * - nodes_per_second: expansions per second of wall-clock time,
+ * - bytes_per_node: peak memory over peak nodes held, from SearchStats,
+ * - first_solution_ms: time until the engine found its first solution, which anytime engines report before returning,
+ * - expanded, generated and solution_cost of the last run, which should not change between commits unless an engine's behaviour does.
+ *
+ * Benchmarks named `replan_<engine>/<domain>/<size>` instead time one query after each of a stream of random cell edits to a maze,
+ * replanning incrementally with D* Lite or from scratch with A*.
+ *
+ * Benchmarks named `batch_<mode>/maze_random/<threads>` solve 256 random 64 x 64 mazes with A* and report instances_per_second:
+ * `batch_fresh` builds an engine per maze on one thread, `batch_pool` runs solve_batch with one reused engine per worker.
+ *
+ * Record a baseline with `--benchmark_out=baseline.json --benchmark_out_format=json` and compare two such files with
+ * Google Benchmark's tools/compare.py. New engines are added to register_engines().
+ */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "generators.h"
+#include "engine/anytime_astar.h"
+#include "engine/batch.h"
+#include "engine/astar.h"
+#include "engine/beam.h"
+#include "engine/bfs.h"
+#include "engine/bidirectional.h"
+#include "engine/dstar_lite.h"
+#include "engine/idastar.h"
+#include "engine/memory_bounded.h"
+#include "engine/parallel_astar.h"
+#include "engine/parallel_bfs.h"
+
+namespace {
+
+constexpr unsigned SEED = 42;
+
+template <class Engine>
+void measure(benchmark::State &state, Engine &engine) {
+    double seconds = 0.0;
+    double first = -1.0;
+    if constexpr (requires { engine.on_solution; }) {
+        engine.on_solution = [&first](const AnytimeSolution &solution) {
+            if (first < 0) {
+                first = solution.seconds;
+            }
+        };
+    }
+    for (auto _ : state) {
+        first = -1.0;
+        benchmark::DoNotOptimize(engine.search());
+        seconds += first >= 0 ? first : engine.stats().search_seconds;
+    }
+    const SearchStats &stats = engine.stats();
+    auto iterations = static_cast<double>(state.iterations());
+    state.counters["nodes_per_second"] = benchmark::Counter(static_cast<double>(stats.expanded) * iterations, benchmark::Counter::kIsRate);
+    state.counters["bytes_per_node"] = stats.peak_nodes ? static_cast<double>(stats.peak_memory) / stats.peak_nodes : 0.0;
+    state.counters["first_solution_ms"] = 1e3 * seconds / iterations;
+    state.counters["expanded"] = static_cast<double>(stats.expanded);
+    state.counters["generated"] = static_cast<double>(stats.generated);
+    state.counters["solution_cost"] = stats.solved ? stats.solution_cost : -1.0;
+}
+
+/// Builds an engine over the problem for every run of the benchmark, so each run starts cold.
+template <class Make>
+void add(const std::string &engine, const std::string &domain, int size, Make make) {
+    std::string name = engine + "/" + domain + "/" + std::to_string(size);
+    benchmark::RegisterBenchmark(name.c_str(), [make](benchmark::State &state) {
+        auto search = make();
+        measure(state, *search);
+    })->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+/**
+ * @brief Registers every engine on one instance.
+ *
+ * @param tree_search Also run the engines without duplicate detection (IDA*, SMA*), which only suit small instances.
+ * @param beam Also run beam search. It keeps no closed set, so it can cycle forever once the beam loses the only way out of a dead end.
+ */
+template <class P>
+void register_engines(const std::string &domain, int size, std::shared_ptr<const P> problem, bool tree_search, bool beam = true) {
+    add("bfs", domain, size, [problem] { return std::make_unique<BFS<P>>(*problem); });
+    add("uniform_cost", domain, size, [problem] { return std::make_unique<UniformCost<P>>(*problem); });
+    add("astar", domain, size, [problem] { return std::make_unique<AStar<P>>(*problem); });
+    add("anytime_astar", domain, size, [problem] { return std::make_unique<AnytimeAStar<P>>(*problem); });
+    if (beam) {
+        add("beam_64", domain, size, [problem] { return std::make_unique<Beam<P>>(*problem, 64, true); });
+    }
+    add("parallel_astar", domain, size, [problem] { return std::make_unique<ParallelAStar<P>>(*problem); });
+    add("parallel_bfs", domain, size, [problem] { return std::make_unique<ParallelBFS<P>>(*problem); });
+    if constexpr (BidirectionalProblem<P>) {
+        add("bidirectional", domain, size, [problem] { return std::make_unique<Bidirectional<P>>(*problem); });
+    }
+    if (tree_search) {
+        add("ida_star", domain, size, [problem] { return std::make_unique<IDAStar<P>>(*problem, 1 << 16); });
+        add("memory_bounded_astar", domain, size, [problem] {
+            return std::make_unique<MemoryBoundedAStar<P>>(*problem, std::size_t(16) << 20, 1000000);
+        });
+    }
+}
+
+/**
+ * @brief Registers replanning after single cell edits on an n x n random maze.
+ *
+ * Every iteration flips one seeded random cell (never the start or goal) and plans again. The engine is built once per benchmark,
+ * so incremental engines carry their work over from one edit to the next.
+ */
+template <class Engine>
+void add_replanning(const std::string &engine, int n) {
+    std::string name = "replan_" + engine + "/maze_random/" + std::to_string(n);
+    benchmark::RegisterBenchmark(name.c_str(), [n](benchmark::State &state) {
+        std::shared_ptr<MazeGrid> grid = random_maze_grid(n, 0.3, SEED);
+        MazeProblem maze(grid, 0, 0);
+        Engine planner(maze);
+        planner.search();
+        std::mt19937 random(SEED);
+        std::uniform_int_distribution<int> coordinate(0, n - 1);
+        std::uint64_t expanded = 0;
+        for (auto _ : state) {
+            int x = coordinate(random);
+            int y = coordinate(random);
+            if (grid->at(x, y) != MazeGrid::GOAL && (x != 0 || y != 0)) {
+                grid->set(x, y, grid->at(x, y) == MazeGrid::WALL ? MazeGrid::FREE : MazeGrid::WALL);
+                if constexpr (requires { planner.changed(MazeState(x, y)); }) {
+                    planner.changed(MazeState(x, y));
+                }
+            }
+            benchmark::DoNotOptimize(planner.search());
+            expanded += planner.stats().expanded;
+        }
+        state.counters["expanded"] = static_cast<double>(expanded) / static_cast<double>(state.iterations());
+    })->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+/**
+ * @brief Registers throughput of many small A* searches, with a fresh engine per instance or with solve_batch on a pool.
+ *
+ * @param threads Workers of the pool; 0 registers the single-threaded baseline that builds an engine per instance.
+ */
+void add_batch(unsigned threads) {
+    std::string name = threads == 0 ? "batch_fresh/maze_random/1" : "batch_pool/maze_random/" + std::to_string(threads);
+    benchmark::RegisterBenchmark(name.c_str(), [threads](benchmark::State &state) {
+        std::vector<std::unique_ptr<MazeProblem>> mazes;
+        std::vector<const MazeProblem *> problems;
+        for (unsigned i = 0; i < 256; i++) {
+            mazes.push_back(std::make_unique<MazeProblem>(random_maze_grid(64, 0.3, SEED + i), 0, 0));
+            problems.push_back(mazes.back().get());
+        }
+        std::unique_ptr<WorkStealingPool> pool = threads ? std::make_unique<WorkStealingPool>(threads) : nullptr;
+        double utilization = 0.0;
+        for (auto _ : state) {
+            if (pool) {
+                auto report = solve_batch<MazeProblem>(*pool, problems, [](const auto &slot) { return AStar(slot); },
+                                                       [](const auto &, NodeId goal, const MazeProblem &) { return goal; });
+                utilization += report.summary.utilization();
+            } else {
+                for (const MazeProblem *maze : problems) {
+                    AStar<MazeProblem> engine(*maze);
+                    benchmark::DoNotOptimize(engine.search());
+                }
+                utilization += 1.0;
+            }
+        }
+        auto iterations = static_cast<double>(state.iterations());
+        state.counters["instances_per_second"] =
+            benchmark::Counter(static_cast<double>(problems.size()) * iterations, benchmark::Counter::kIsRate);
+        state.counters["utilization"] = utilization / iterations;
+    })->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+void register_all() {
+    for (int n : {16, 256, 1024}) {
+        auto maze = std::make_shared<const MazeProblem>(random_maze_grid(n, 0.3, SEED), 0, 0);
+        register_engines<MazeProblem>("maze_random", n, maze, n <= 16);
+    }
+    for (int n : {256, 1024}) {
+        add_replanning<AStar<MazeProblem>>("astar", n);
+        add_replanning<DStarLite<MazeProblem>>("dstar_lite", n);
+    }
+    add_batch(0);
+    for (unsigned threads : {1u, 4u}) {
+        add_batch(threads);
+    }
+    for (int n : {15, 129, 513}) {
+        auto maze = std::make_shared<const MazeProblem>(perfect_maze_grid(n, SEED), 1, 1);
+        register_engines<MazeProblem>("maze_perfect", n, maze, n <= 15, false);
+    }
+    for (int n : {6, 10, 14}) {
+        auto scheduler = std::make_shared<const TaskScheduler>(random_tasks(n, SEED));
+        register_engines<TaskScheduler>("task_scheduler", n, scheduler, n <= 6);
+    }
+    for (int k : {2, 4, 6}) {
+        std::shared_ptr<const StudyProblem> plan = random_study_plan(k, SEED);
+        register_engines<StudyProblem>("study_plan", k, plan, k <= 2);
+    }
+    for (int rooms : {4, 10, 14}) {
+        auto vacuum = std::make_shared<const VacuumCleaner>(rooms);
+        register_engines<VacuumCleaner>("vacuum", rooms, vacuum, rooms <= 4);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    register_all();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file generators.h
+ * @brief Seeded instance generators for the bundled problem domains, scaled by a size parameter.
+ */
+
+#ifndef BENCH_GENERATORS_H
+#define BENCH_GENERATORS_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "problems/simple_maze.h"
+#include "problems/study_path.h"
+#include "problems/task_scheduler.h"
+#include "problems/vacuum.h"
+
+/**
+ * @brief An n x n grid with each cell a wall with the given probability, solvable from (0, 0) to (n - 1, n - 1).
+ *
+ * A random monotone staircase from the start to the goal is cleared after the walls are placed, so a solution always exists.
+ */
+inline std::shared_ptr<MazeGrid> random_maze_grid(int n, double walls, unsigned seed) {
+    auto grid = std::make_shared<MazeGrid>(n, n);
+    std::mt19937 random(seed);
+    std::bernoulli_distribution wall(walls);
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            if (wall(random)) {
+                grid->set(x, y, MazeGrid::WALL);
+            }
+        }
+    }
+    std::bernoulli_distribution down(0.5);
+    for (int x = 0, y = 0; x != n - 1 || y != n - 1;) {
+        grid->set(x, y, MazeGrid::FREE);
+        if (y == n - 1 || (x < n - 1 && down(random))) {
+            x++;
+        } else {
+            y++;
+        }
+    }
+    grid->set_goal(n - 1, n - 1);
+    return grid;
+}
+
+/**
+ * @brief A perfect maze (exactly one path between any two open cells) carved by a randomized depth-first search.
+ *
+ * Open cells sit on odd coordinates with walls in between, so the grid is (2k + 1) x (2k + 1) for n rounded down to an odd size.
+ * The start is (1, 1) and the goal the opposite corner.
+ */
+inline std::shared_ptr<MazeGrid> perfect_maze_grid(int n, unsigned seed) {
+    if (n % 2 == 0) {
+        n--;
+    }
+    auto grid = std::make_shared<MazeGrid>(n, n);
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            grid->set(x, y, MazeGrid::WALL);
+        }
+    }
+    std::mt19937 random(seed);
+    const int dx[] = {-2, 2, 0, 0};
+    const int dy[] = {0, 0, -2, 2};
+    std::vector<std::pair<int, int>> stack{{1, 1}};
+    grid->set(1, 1, MazeGrid::FREE);
+    while (!stack.empty()) {
+        auto [x, y] = stack.back();
+        int options[4];
+        int count = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d];
+            int ny = y + dy[d];
+            if (nx > 0 && ny > 0 && nx < n - 1 && ny < n - 1 && grid->at(nx, ny) == MazeGrid::WALL) {
+                options[count++] = d;
+            }
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = options[std::uniform_int_distribution<int>(0, count - 1)(random)];
+        grid->set(x + dx[d] / 2, y + dy[d] / 2, MazeGrid::FREE);
+        grid->set(x + dx[d], y + dy[d], MazeGrid::FREE);
+        stack.emplace_back(x + dx[d], y + dy[d]);
+    }
+    grid->set_goal(n - 2, n - 2);
+    return grid;
+}
+
+/// n tasks with random priorities from 1 to 9 and deadlines from 1 to 2n.
+inline std::vector<Task> random_tasks(int n, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> priority(1, 9);
+    std::uniform_int_distribution<int> deadline(1, 2 * n);
+    std::vector<Task> tasks;
+    for (int i = 0; i < n; i++) {
+        tasks.emplace_back("Task " + std::to_string(i + 1), priority(random), deadline(random));
+    }
+    return tasks;
+}
+
+/**
+ * @brief A study plan over k topics with random starting mastery of 60, 70 or 80 percent, no prerequisites and no synergies.
+ *
+ * The time budget is large enough for every topic to be mastered.
+ */
+inline std::unique_ptr<StudyProblem> random_study_plan(int k, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> level(6, 8);
+    std::map<std::string, double> mastery;
+    for (int i = 0; i < k; i++) {
+        mastery["Topic " + std::to_string(i + 1)] = 10.0 * level(random);
+    }
+    return std::make_unique<StudyProblem>(new StudyState(std::move(mastery), 10.0 * k), std::map<std::string, std::vector<std::string>>{},
+                                          std::map<std::string, double>{});
+}
+
+#endif // BENCH_GENERATORS_H
@@ -28,13 +28,42 @@ int main(int argc, char **argv) {
         .help("The search algorithm to use")
         .default_value(std::string("breadth_first_search"))
         .action([](const std::string &value) {
-            static const std::vector<std::string> choices = {"breadth_first_search", "a_star", "beam_search"};
+            static const std::vector<std::string> choices = {"breadth_first_search", "uniform_cost_search", "a_star", "beam_search", "parallel_a_star", "bidirectional_search", "ida_star", "memory_bounded_a_star", "anytime_a_star", "d_star_lite"};
             if (std::find(choices.begin(), choices.end(), value) != choices.end()) {
                 return value;
             }
             return std::string("breadth_first_search");
         });
 
+    program.add_argument("--stats")
+        .help("Print search statistics after the search: json or csv")
+        .default_value(std::string(""));
+
+    program.add_argument("--phase-timers")
+        .help("Also time expansions, heuristic calls and frontier operations")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--heuristic-cache")
+        .help("Cache this many heuristic values (a_star, ida_star, memory_bounded_a_star)")
+        .default_value(std::size_t(0))
+        .action([](const std::string &value) { return static_cast<std::size_t>(std::stoul(value)); });
+
+    program.add_argument("--time-limit")
+        .help("Stop searching after this many milliseconds; anytime_a_star returns its best solution so far")
+        .default_value(std::size_t(0))
+        .action([](const std::string &value) { return static_cast<std::size_t>(std::stoul(value)); });
+
+    program.add_argument("--node-limit")
+        .help("Stop searching after this many expansions")
+        .default_value(std::size_t(0))
+        .action([](const std::string &value) { return static_cast<std::size_t>(std::stoul(value)); });
+
+    program.add_argument("--memory-limit")
+        .help("Stop searching once nodes and frontier take this many MiB")
+        .default_value(std::size_t(0))
+        .action([](const std::string &value) { return static_cast<std::size_t>(std::stoul(value)); });
+
     try {
         program.parse_args(argc, argv);
     } catch (const std::runtime_error &err) {
@@ -45,14 +74,46 @@ int main(int argc, char **argv) {
 
     std::string problem = program.get<std::string>("problem");
     std::string algorithm = program.get<std::string>("algorithm");
+    std::string stats_format = program.get<std::string>("--stats");
+    if (!stats_format.empty() && stats_format != "json" && stats_format != "csv") {
+        std::cerr << "Unknown statistics format: " << stats_format << std::endl;
+        return 1;
+    }
+    SearchConfig config;
+    config.phase_timers = program.get<bool>("--phase-timers");
+    config.heuristic_cache_entries = program.get<std::size_t>("--heuristic-cache");
+    config.time_limit = static_cast<double>(program.get<std::size_t>("--time-limit")) / 1000.0;
+    config.node_limit = program.get<std::size_t>("--node-limit");
+    config.memory_limit = program.get<std::size_t>("--memory-limit") << 20;
+    auto print_stats = [&stats_format](const Search &search) {
+        if (stats_format == "json") {
+            std::cout << search.stats.to_json() << std::endl;
+        } else if (stats_format == "csv") {
+            std::cout << SearchStats::csv_header() << std::endl << search.stats.to_csv() << std::endl;
+        }
+    };
 
     SearchAlgorithmIndex algorithm_index;
     if (algorithm == "breadth_first_search") {
         algorithm_index = SearchAlgorithmIndex::BREADTH_FIRST_SEARCH;
+    } else if (algorithm == "uniform_cost_search") {
+        algorithm_index = SearchAlgorithmIndex::UNIFORM_COST_SEARCH;
     } else if (algorithm == "a_star") {
         algorithm_index = SearchAlgorithmIndex::A_STAR;
     } else if (algorithm == "beam_search") {
         algorithm_index = SearchAlgorithmIndex::BEAM_SEARCH;
+    } else if (algorithm == "parallel_a_star") {
+        algorithm_index = SearchAlgorithmIndex::PARALLEL_A_STAR;
+    } else if (algorithm == "bidirectional_search") {
+        algorithm_index = SearchAlgorithmIndex::BIDIRECTIONAL_SEARCH;
+    } else if (algorithm == "ida_star") {
+        algorithm_index = SearchAlgorithmIndex::IDA_STAR;
+    } else if (algorithm == "memory_bounded_a_star") {
+        algorithm_index = SearchAlgorithmIndex::MEMORY_BOUNDED_A_STAR;
+    } else if (algorithm == "anytime_a_star") {
+        algorithm_index = SearchAlgorithmIndex::ANYTIME_A_STAR;
+    } else if (algorithm == "d_star_lite") {
+        algorithm_index = SearchAlgorithmIndex::D_STAR_LITE;
     } else {
         std::cerr << "Unknown algorithm: " << algorithm << std::endl;
         return 1;
@@ -60,7 +121,7 @@ int main(int argc, char **argv) {
 
     if (problem == "vacuum") {
         VacuumCleaner vacuum_cleaner;
-        Search *search = create_search(algorithm_index, &vacuum_cleaner);
+        Search *search = create_search(algorithm_index, &vacuum_cleaner, config);
         std::shared_ptr<Node> node = search->search();
 
         if (node) {
@@ -70,27 +131,28 @@ int main(int argc, char **argv) {
         } else {
             std::cout << "Solution not found!" << std::endl;
         }
+        print_stats(*search);
 
         delete search;
     } else if (problem == "maze") {
         MazeProblem maze_problem;
-        Search *search = create_search(algorithm_index, &maze_problem);
+        Search *search = create_search(algorithm_index, &maze_problem, config);
         auto node = search->search();
 
         if (node) {
             std::cout << "Solution found!" << std::endl;
-            State *maze_state = node->state.get();
-            maze_state->print();
+            maze_problem.print(static_cast<const MazeState &>(*node->state));
             Solution solution(node.get());
             solution.print();
         } else {
             std::cout << "Solution not found!" << std::endl;
         }
+        print_stats(*search);
 
         delete search;
     } else if (problem == "task_scheduler") {
         TaskScheduler task_scheduler;
-        Search *search = create_search(algorithm_index, &task_scheduler);
+        Search *search = create_search(algorithm_index, &task_scheduler, config);
         auto node = search->search();
 
         if (node) {
@@ -102,6 +164,7 @@ int main(int argc, char **argv) {
         } else {
             std::cout << "Solution not found!" << std::endl;
         }
+        print_stats(*search);
 
         delete search;
     } else if (problem == "study_path") {
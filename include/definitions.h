@@ -6,10 +6,32 @@
 #ifndef DEFINITIONS_H
 #define DEFINITIONS_H
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <memory>
 
+/**
+ * @brief Mixes a value into a running hash seed.
+ *
+ * Helper for State::hash() implementations that need to combine several fields.
+ *
+ * @param seed The hash accumulated so far.
+ * @param value The hash of the next field.
+ * @return The combined hash.
+ */
+inline std::size_t hash_combine(std::size_t seed, std::size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
 /**
  * @brief Represents an abstract state in a problem.
  *
@@ -33,6 +55,53 @@ public:
      * This method should be overridden by the user to display meaningful information about the state.
      */
     virtual void print() {}
+
+    /**
+     * @brief Hashes the contents of the state.
+     *
+     * Override together with equals() so that search algorithms can recognise the same state reached along different paths.
+     * The default falls back to object identity, which never merges two distinct objects.
+     *
+     * @return A hash of the state's contents.
+     */
+    virtual std::size_t hash() const { return std::hash<const State *>{}(this); }
+
+    /**
+     * @brief Tests whether two states describe the same configuration.
+     *
+     * Must agree with hash(): states that compare equal have to produce the same hash.
+     *
+     * @param other The state to compare against.
+     * @return True if both states are interchangeable for the search.
+     */
+    virtual bool equals(const State &other) const { return this == &other; }
+
+    /**
+     * @brief Packs the state into a fixed-width key.
+     *
+     * States that fit into 64 bits can override this to let duplicate detection use a compact key table instead of storing state pointers.
+     * Two states must pack to the same key exactly when they compare equal, and the all-ones key is reserved.
+     *
+     * @param key Receives the packed key.
+     * @return True if the state was packed, false if the state does not support packing.
+     */
+    virtual bool pack(std::uint64_t &key) const { (void) key; return false; }
+};
+
+/**
+ * @brief Hash functor that keys containers on state contents rather than pointer identity.
+ */
+struct StateHash {
+    std::size_t operator()(const std::shared_ptr<State> &state) const { return state->hash(); }
+};
+
+/**
+ * @brief Equality functor matching StateHash.
+ */
+struct StateEqual {
+    bool operator()(const std::shared_ptr<State> &a, const std::shared_ptr<State> &b) const {
+        return a == b || a->equals(*b);
+    }
 };
 
 /**
@@ -52,6 +121,95 @@ public:
      : name(name), cost(cost), source_state(source_state), effect(effect) {}
 };
 
+/// Interned identifier of an action name.
+using ActionId = std::uint32_t;
+
+/**
+ * @brief Interns action names to dense ActionId values.
+ *
+ * Lets successors carry a 32-bit id instead of an owned string. Names are only looked up again when a solution path is reported.
+ * Interning is thread-safe.
+ */
+class ActionTable {
+public:
+    /**
+     * @brief Returns the id of a name, assigning the next free id on first use.
+     */
+    ActionId intern(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = ids.try_emplace(name, static_cast<ActionId>(names.size()));
+        if (inserted) {
+            names.push_back(name);
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Returns the name of an interned id.
+     */
+    const std::string &name(ActionId id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names[id];
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.size();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::deque<std::string> names; // deque keeps returned references valid while interning continues
+    std::unordered_map<std::string, ActionId> ids;
+};
+
+/**
+ * @brief A successor produced by expanding a state: the action taken, its cost and the resulting state.
+ */
+template <class S>
+struct Successor {
+    ActionId action;
+    double cost;
+    S state;
+
+    template <class... Args>
+    Successor(ActionId action, double cost, Args &&... args)
+        : action(action), cost(cost), state(std::forward<Args>(args)...) {}
+};
+
+/**
+ * @brief Reusable output buffer that a problem fills with the successors of a state.
+ *
+ * The buffer is owned by the search engine and cleared, not freed, between expansions,
+ * so once it has grown to the largest branching factor generating successors allocates nothing beyond what the states themselves need.
+ */
+template <class S>
+class SuccessorBuffer {
+public:
+    /**
+     * @brief Appends a successor, constructing its state in place from the given arguments.
+     */
+    template <class... Args>
+    void emplace(ActionId action, double cost, Args &&... args) {
+        items.emplace_back(action, cost, std::forward<Args>(args)...);
+    }
+
+    void clear() { items.clear(); }
+    std::size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    Successor<S> &operator[](std::size_t i) { return items[i]; }
+    /// The first count successors as one contiguous run, e.g. for batched heuristic evaluation.
+    std::span<const Successor<S>> first(std::size_t count) const { return {items.data(), count}; }
+    std::span<const Successor<S>> all() const { return {items.data(), items.size()}; }
+    auto begin() { return items.begin(); }
+    auto end() { return items.end(); }
+    auto begin() const { return items.begin(); }
+    auto end() const { return items.end(); }
+
+private:
+    std::vector<Successor<S>> items;
+};
+
 
 
 /**
@@ -92,12 +250,57 @@ public:
     /**
      * @brief Retrieves the set of actions applicable to a given state.
      *
-     * This method must be implemented by the user to define the available actions for a specific state.
+     * Override either this method or expand(). The default builds Action objects from expand().
      *
      * @param state The current state.
      * @return A vector of actions applicable to the given state.
      */
-    virtual std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) = 0;
+    virtual std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) {
+        SuccessorBuffer<std::shared_ptr<State>> successors;
+        expand(state, successors);
+        std::vector<std::shared_ptr<Action>> result;
+        for (auto &successor : successors) {
+            result.push_back(std::make_shared<Action>(action_name(successor.action), successor.cost, state, successor.state));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Emits the successors of a state into an engine-provided buffer.
+     *
+     * This is the interface the search engines call. Override it to avoid allocating an Action per successor.
+     * The default adapts actions(), interning action names in action_table.
+     *
+     * @param state The state to expand.
+     * @param out Receives one entry per applicable action.
+     * @throws std::logic_error if the problem overrides neither this method nor actions().
+     */
+    virtual void expand(const std::shared_ptr<State> &state, SuccessorBuffer<std::shared_ptr<State>> &out) {
+        // The default actions() calls back into expand(), so arriving here again for the same problem means neither was overridden
+        static thread_local const Problem *adapting = nullptr;
+        if (adapting == this) {
+            throw std::logic_error("A Problem must override actions() or expand()");
+        }
+        struct Restore {
+            const Problem *previous;
+            ~Restore() { adapting = previous; }
+        } restore{std::exchange(adapting, this)};
+        for (auto &action : actions(state)) {
+            out.emplace(action_table.intern(action->name), action->cost, action->effect);
+        }
+    }
+
+    /**
+     * @brief Declares whether every action cost and heuristic value is a non-negative integer.
+     *
+     * Best-first searches use this to switch to integer-keyed frontiers such as a bucket queue.
+     */
+    virtual bool integral_costs() const { return false; }
+
+    /**
+     * @brief Returns the name of an action id emitted by expand().
+     */
+    virtual const std::string &action_name(ActionId action) const { return action_table.name(action); }
 
     /**
      * @brief Computes a heuristic estimate for a given state.
@@ -109,8 +312,133 @@ public:
      */
     virtual double heuristic(State *state) = 0;
 
+    /**
+     * @brief Computes the heuristic of a run of successors at once; the engines call it once per expansion.
+     *
+     * Override it with a vectorized version when the heuristic suits one (see heuristic_kernels.h). The default calls heuristic() per state.
+     *
+     * @param successors The successors to evaluate.
+     * @param out Receives one estimate per successor, in order.
+     */
+    virtual void heuristic_batch(std::span<const Successor<std::shared_ptr<State>>> successors, std::span<double> out) {
+        for (std::size_t i = 0; i < successors.size(); i++) {
+            out[i] = heuristic(successors[i].state.get());
+        }
+    }
+
+    /**
+     * @brief Returns the goal state that bidirectional search expands backward from.
+     *
+     * @return The single goal state, or nullptr if goals are only known through goal_test().
+     */
+    virtual std::shared_ptr<State> goal_state() { return nullptr; }
+
+    /**
+     * @brief Emits the predecessors of a state: the states with an action leading to it.
+     *
+     * Each entry carries the forward action, its cost and the state it starts from. Needed, together with goal_state(), by bidirectional search.
+     *
+     * @throws std::logic_error unless overridden.
+     */
+    virtual void predecessors(const std::shared_ptr<State> &state, SuccessorBuffer<std::shared_ptr<State>> &out) {
+        (void) state;
+        (void) out;
+        throw std::logic_error("This problem does not provide predecessors");
+    }
+
+    /**
+     * @brief Estimates the cost from the initial state to a given state, used by the backward half of bidirectional search.
+     *
+     * Defaults to 0, which is always admissible.
+     */
+    virtual double reverse_heuristic(State *state) {
+        (void) state;
+        return 0;
+    }
+
     /// Pointer to the initial state of the problem.
     State *initial_state_;
+
+    /// Action names interned by the default expand().
+    ActionTable action_table;
+};
+
+/**
+ * @brief Base for problems that are solved both through the Problem interface and by the templated engines.
+ *
+ * The derived class implements the typed interface on its concrete state type S
+ * (`is_goal`, `h`, `expand` into a SuccessorBuffer<S> and `action_name`), and this class forwards the virtual Problem methods to it,
+ * so the same problem runs on the virtual Search classes and directly on the engines without casts in the hot loop.
+ * State identity defaults to `S::hash()` and `S::operator==`.
+ * Derived classes that also provide `goal()`, `predecessors(state, out)` and optionally `h_reverse(state)` are exposed to bidirectional search.
+ *
+ * @tparam Derived The problem class (CRTP).
+ * @tparam S The concrete state class, derived from State.
+ */
+template <class Derived, class S>
+class TypedProblem : public Problem {
+public:
+    using state_type = S;
+
+    /// The initial state by value.
+    S initial() const { return *static_cast<const S *>(initial_state_); }
+
+    std::size_t hash(const S &state) const { return state.hash(); }
+    bool equal(const S &a, const S &b) const { return a == b; }
+
+    bool goal_test(State *state) override { return derived().is_goal(*static_cast<S *>(state)); }
+
+    double heuristic(State *state) override { return derived().h(*static_cast<S *>(state)); }
+
+    // One virtual call per batch, then direct calls to the typed heuristic
+    void heuristic_batch(std::span<const Successor<std::shared_ptr<State>>> successors, std::span<double> out) override {
+        for (std::size_t i = 0; i < successors.size(); i++) {
+            out[i] = derived().h(static_cast<const S &>(*successors[i].state));
+        }
+    }
+
+    void expand(const std::shared_ptr<State> &state, SuccessorBuffer<std::shared_ptr<State>> &out) override {
+        thread_local SuccessorBuffer<S> successors;
+        successors.clear();
+        derived().expand(static_cast<const S &>(*state), successors);
+        for (auto &successor : successors) {
+            out.emplace(successor.action, successor.cost, std::make_shared<S>(std::move(successor.state)));
+        }
+    }
+
+    std::shared_ptr<State> goal_state() override {
+        if constexpr (requires(const Derived &problem) { problem.goal(); }) {
+            return std::make_shared<S>(derived().goal());
+        } else {
+            return nullptr;
+        }
+    }
+
+    void predecessors(const std::shared_ptr<State> &state, SuccessorBuffer<std::shared_ptr<State>> &out) override {
+        if constexpr (requires(const Derived &problem, SuccessorBuffer<S> &buffer) { problem.predecessors(static_cast<const S &>(*state), buffer); }) {
+            thread_local SuccessorBuffer<S> successors;
+            successors.clear();
+            derived().predecessors(static_cast<const S &>(*state), successors);
+            for (auto &successor : successors) {
+                out.emplace(successor.action, successor.cost, std::make_shared<S>(std::move(successor.state)));
+            }
+        } else {
+            Problem::predecessors(state, out);
+        }
+    }
+
+    double reverse_heuristic(State *state) override {
+        if constexpr (requires(const Derived &problem) { problem.h_reverse(*static_cast<S *>(state)); }) {
+            return derived().h_reverse(*static_cast<S *>(state));
+        } else {
+            return 0;
+        }
+    }
+
+    const std::string &action_name(ActionId action) const override = 0;
+
+private:
+    const Derived &derived() const { return static_cast<const Derived &>(*this); }
 };
 
 #endif // DEFINITIONS_H
@@ -0,0 +1,263 @@
+/**
+ * @file anytime_astar.h
+ * @brief Compile-time specialized anytime repairing A* (ARA*).
+ */
+
+#ifndef ENGINE_ANYTIME_ASTAR_H
+#define ENGINE_ANYTIME_ASTAR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief A solution reported by AnytimeAStar while it keeps searching for better ones.
+ */
+struct AnytimeSolution {
+    NodeId goal;             ///< Goal node in the engine's nodes(); its path stays readable until the next search
+    double cost;             ///< Path cost of the solution
+    double weight;           ///< Heuristic weight of the iteration that found or confirmed it
+    double bound;            ///< Suboptimality bound: the cost is at most bound times the optimal cost, for a consistent heuristic
+    double seconds;          ///< Time since the search started
+    std::uint64_t expanded;  ///< Expansions since the search started
+};
+
+/**
+ * @brief Anytime repairing A* (ARA*) over a problem known at compile time.
+ *
+ * Runs weighted A*, ordering nodes by f = g + weight * h, starting from a large weight that finds a first solution quickly.
+ * Each following iteration lowers the weight and continues from the previous one instead of restarting: states whose cost improved
+ * after they were expanded wait in an inconsistent list, and only those are queued again with the open states, re-sorted for the new weight.
+ * Within an iteration a state is expanded at most once. With a consistent heuristic, each solution costs at most weight times the optimum,
+ * and the bound reported with it is often tighter, from the lowest unweighted f left to explore. Once the weight reaches 1 the search ends
+ * with an optimal solution.
+ *
+ * The search also ends when one of its limits is reached, returning the best solution found so far; on_solution streams every
+ * solution as it improves. The heuristic is evaluated once per state, as in AStar, and goals are recognized when generated.
+ */
+template <SearchProblem P>
+class AnytimeAStar : public EngineBase<P> {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param initial_weight Heuristic weight of the first iteration; values below 1 are raised to 1, which runs plain A*.
+     * @param weight_step Amount the weight drops after each iteration, down to 1; 0 or less goes to 1 directly.
+     */
+    explicit AnytimeAStar(const P &problem, double initial_weight = 2.5, double weight_step = 0.5)
+        : EngineBase<P>(problem), initial_weight(initial_weight), weight_step(weight_step) {}
+
+    /**
+     * @brief Runs the search until the solution is proven optimal, the state space is exhausted or a limit is reached.
+     *
+     * @return The best goal node found in nodes(), or NO_NODE if no solution exists or none was found within the limits.
+     */
+    NodeId search() {
+        this->begin_search();
+        records.clear();
+        slots.clear();
+        inconsistent.clear();
+        open.clear();
+        expanded = 0;
+        iteration = 1;
+        best = NO_NODE;
+        best_cost = INF;
+        best_bound = INF;
+        reported_cost = INF;
+        reported_bound = INF;
+
+        NodeId root = this->add_root();
+        records.push_back(Record{0.0, this->arena[root].heuristic, root, 0, true, false});
+        slots.emplace(this->arena[root].state, 0);
+        if (this->problem.is_goal(this->arena[root].state)) {
+            best = root;
+            best_cost = 0.0;
+        }
+
+        double weight = std::max(1.0, initial_weight);
+        queue(weight);
+        while (true) {
+            improve(weight);
+            if (best != NO_NODE) {
+                report(weight);
+            }
+            bool exhausted = open.empty() && inconsistent.empty();
+            if (stopped() || exhausted || best_bound <= 1.0 || (weight == 1.0 && inconsistent.empty())) {
+                break;
+            }
+            weight = weight_step > 0 ? std::max(1.0, weight - weight_step) : 1.0;
+            iteration++;
+            for (std::uint32_t slot : inconsistent) {
+                records[slot].inconsistent = false;
+                records[slot].open = true;
+            }
+            inconsistent.clear();
+            queue(weight);
+        }
+        return this->finish(best, sizeof(FrontierEntry));
+    }
+
+    /// Suboptimality bound of the solution returned by the last search: 1 when proven optimal, infinite without a solution.
+    double suboptimality_bound() const { return best_bound; }
+
+    /// True if the last search stopped at one of its limits before proving its solution optimal.
+    bool interrupted() const { return stopped(); }
+
+    /// Nodes expanded by the last search, over all iterations.
+    std::size_t expansions() const { return expanded; }
+
+    double initial_weight;
+    double weight_step;
+    /// Called with every solution that improves on the cost or the bound of the previous one, from the searching thread.
+    std::function<void(const AnytimeSolution &)> on_solution;
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+    struct Record {
+        double g;                     // Cheapest known path cost
+        double h;                     // Unweighted heuristic; NaN until evaluated
+        NodeId node;                  // Node holding the cheapest known path
+        std::uint32_t closed;         // Iteration in which the state was last expanded
+        bool open;                    // Queued in the frontier of the current iteration
+        bool inconsistent;            // Improved after its expansion in this iteration, waiting for the next one
+    };
+    struct Pending {
+        std::uint32_t slot;
+        double g;
+    };
+
+    std::vector<Record> records;
+    std::unordered_map<typename P::state_type, std::uint32_t, ProblemHash<P>, ProblemEqual<P>> slots{
+        0, ProblemHash<P>{&this->problem}, ProblemEqual<P>{&this->problem}};
+    std::vector<std::uint32_t> inconsistent;
+    std::vector<Pending> pending;
+    IndexedHeapFrontier open;
+    std::size_t expanded = 0;
+    std::uint32_t iteration = 1;
+    NodeId best = NO_NODE;
+    double best_cost = INF;
+    double best_bound = INF;
+    double reported_cost = INF;
+    double reported_bound = INF;
+
+    /// Rebuilds the frontier from the open states, ordered for the given weight.
+    void queue(double weight) {
+        open.clear();
+        for (std::uint32_t slot = 0; slot < records.size(); slot++) {
+            const Record &record = records[slot];
+            if (record.open) {
+                open.push(record.node, slot, record.g + weight * record.h, record.h);
+            }
+        }
+    }
+
+    bool stopped() const { return this->stop_reason.has_value(); }
+
+    /// Expands states in order of weighted f until none could lead to a cheaper solution than the best one.
+    void improve(double weight) {
+        while (!open.empty() && open.top_f() < best_cost) {
+            std::size_t held = records.size() * (sizeof(Record) + sizeof(typename P::state_type)) + open.size() * sizeof(FrontierEntry);
+            if (this->out_of_budget(open.top_f(), held)) {
+                return;
+            }
+            NodeId node;
+            {
+                PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+                node = open.pop();
+            }
+            std::uint32_t slot = slots.find(this->arena[node].state)->second;
+            records[slot].open = false;
+            records[slot].closed = iteration;
+            // Paths through a goal cost at least as much as the goal itself
+            if (this->problem.is_goal(this->arena[node].state)) {
+                continue;
+            }
+            double node_cost = records[slot].g;
+
+            this->expand(node);
+            expanded++;
+            std::size_t fresh = 0;
+            pending.clear();
+            for (std::size_t i = 0; i < this->successors.size(); i++) {
+                auto &successor = this->successors[i];
+                double path_cost = node_cost + successor.cost;
+                auto next = static_cast<std::uint32_t>(records.size());
+                auto [known, inserted] = slots.try_emplace(successor.state, next);
+                if (inserted) {
+                    records.push_back(Record{path_cost, std::numeric_limits<double>::quiet_NaN(), NO_NODE, 0, false, false});
+                } else if (path_cost >= records[known->second].g) {
+                    this->statistics.count_duplicate();
+                    continue;
+                }
+                records[known->second].g = path_cost;
+                if (std::isnan(records[known->second].h)) {
+                    // Evaluated below with the other new states, as one batch
+                    if (i != fresh) {
+                        std::swap(this->successors[fresh], successor);
+                    }
+                    fresh++;
+                    pending.push_back(Pending{known->second, path_cost});
+                    continue;
+                }
+                update(weight, node, successor, known->second, path_cost);
+            }
+            this->heuristics(this->successors.first(fresh), this->estimates, this->statistics);
+            for (std::size_t i = 0; i < fresh; i++) {
+                records[pending[i].slot].h = this->estimates[i];
+                update(weight, node, this->successors[i], pending[i].slot, pending[i].g);
+            }
+            this->statistics.track_frontier(open.size());
+        }
+    }
+
+    /// Records a cheaper path to a state, and queues the state now or in the next iteration.
+    void update(double weight, NodeId parent, Successor<typename P::state_type> &successor, std::uint32_t slot, double path_cost) {
+        Record &record = records[slot];
+        NodeId child = this->add_child(parent, successor, path_cost, record.h);
+        record.node = child;
+        if (path_cost < best_cost && this->problem.is_goal(this->arena[child].state)) {
+            best = child;
+            best_cost = path_cost;
+        }
+        if (record.closed == iteration) {
+            if (!record.inconsistent) {
+                record.inconsistent = true;
+                inconsistent.push_back(slot);
+            }
+            return;
+        }
+        record.open = true;
+        PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+        open.push(child, slot, path_cost + weight * record.h, record.h);
+    }
+
+    /// Tightens the bound of the best solution and reports it if it improved.
+    void report(double weight) {
+        // No state left to explore has an unweighted f below this, so neither has an optimal solution
+        double lower = INF;
+        for (const Record &record : records) {
+            if (record.open || record.inconsistent) {
+                lower = std::min(lower, record.g + record.h);
+            }
+        }
+        double bound = lower == INF ? 1.0 : lower > 0 ? std::max(1.0, best_cost / lower) : INF;
+        if (!stopped()) {
+            // A completed iteration guarantees its weight
+            bound = std::min(bound, weight);
+        }
+        best_bound = std::min(best_bound, bound);
+        if (on_solution && (best_cost < reported_cost || best_bound < reported_bound)) {
+            reported_cost = best_cost;
+            reported_bound = best_bound;
+            on_solution(AnytimeSolution{best, best_cost, weight, best_bound, this->elapsed_seconds(), expanded});
+        }
+    }
+};
+
+#endif // ENGINE_ANYTIME_ASTAR_H
@@ -0,0 +1,180 @@
+/**
+ * @file astar.h
+ * @brief Compile-time specialized A* search.
+ */
+
+#ifndef ENGINE_ASTAR_H
+#define ENGINE_ASTAR_H
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief A* search over a problem known at compile time.
+ *
+ * Keeps a best-g table keyed on state identity. Stale frontier entries are skipped when popped,
+ * and a closed state is reopened only when a strictly cheaper path to it is found.
+ * The table also keeps each state's heuristic, so it is evaluated once per state and not again for every cheaper path.
+ * The states an expansion reaches for the first time are evaluated together, in one h_batch call when the problem provides it.
+ * The frontier is chosen per search (see FrontierKind). The table and the frontiers are kept between searches, so an engine that runs
+ * many searches (see solve_batch) reuses their memory instead of allocating it again.
+ * Nodes are ordered by f = g + weight * h; the weight is 1 for A* and 0 for UniformCost.
+ */
+template <SearchProblem P>
+class AStar : public EngineBase<P> {
+public:
+    explicit AStar(const P &problem, FrontierKind frontier = FrontierKind::AUTO)
+        : EngineBase<P>(problem), frontier(frontier) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        switch (resolved_frontier()) {
+            case FrontierKind::BUCKET:
+                return run<BucketFrontier>();
+            case FrontierKind::BINARY_HEAP:
+                return run<BinaryHeapFrontier>();
+            default:
+                return run<IndexedHeapFrontier>();
+        }
+    }
+
+    /// The frontier the next search will use, with AUTO resolved against the problem.
+    FrontierKind resolved_frontier() const {
+        if (frontier != FrontierKind::AUTO) {
+            return frontier;
+        }
+        return declares_integral_costs(this->problem) ? FrontierKind::BUCKET : FrontierKind::INDEXED_HEAP;
+    }
+
+    FrontierKind frontier;
+
+protected:
+    double heuristic_weight = 1.0;
+
+private:
+    struct Record {
+        double g;            // Cheapest known path cost
+        std::uint32_t slot;  // Dense id of the state, used by indexed frontiers
+        bool closed;         // Expanded at that cost
+        double h;            // Weighted heuristic, evaluated when the state is first generated; NaN until then
+    };
+    struct Pending {
+        Record *record;  // Stable: unordered_map never moves its elements
+        double g;
+    };
+
+    std::unordered_map<typename P::state_type, Record, ProblemHash<P>, ProblemEqual<P>> best_g{
+        0, ProblemHash<P>{&this->problem}, ProblemEqual<P>{&this->problem}};
+    std::vector<Pending> pending;
+    std::tuple<BucketFrontier, BinaryHeapFrontier, IndexedHeapFrontier> frontiers;
+
+    template <class Frontier>
+    NodeId run() {
+        constexpr double UNEVALUATED = std::numeric_limits<double>::quiet_NaN();
+        this->begin_search();
+        Frontier &open = std::get<Frontier>(frontiers);
+        open.clear();
+        best_g.clear();
+
+        NodeId root = this->add_root(heuristic_weight);
+        double root_h = this->arena[root].heuristic;
+        best_g.emplace(this->arena[root].state, Record{0.0, 0, false, root_h});
+        open.push(root, 0, root_h, root_h);
+
+        while (!open.empty()) {
+            NodeId node;
+            {
+                PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+                node = open.pop();
+            }
+            const auto &state = this->arena[node].state;
+            double node_cost = this->arena[node].path_cost;
+
+            // Skip stale entries superseded by a cheaper path, and duplicates of an expanded state
+            Record &record = best_g.find(state)->second;
+            if (node_cost > record.g || record.closed) {
+                continue;
+            }
+            if (this->problem.is_goal(state)) {
+                return this->finish(node, sizeof(FrontierEntry));
+            }
+            std::size_t held = open.size() * sizeof(FrontierEntry) + best_g.size() * (sizeof(typename P::state_type) + sizeof(Record));
+            if (this->out_of_budget(node_cost + record.h, held)) {
+                return this->finish(NO_NODE, sizeof(FrontierEntry));
+            }
+            record.closed = true;
+
+            this->expand(node);
+            // Settle duplicates first and move the successors still needing a heuristic to the front, to evaluate them as one batch
+            std::size_t fresh = 0;
+            pending.clear();
+            for (std::size_t i = 0; i < this->successors.size(); i++) {
+                auto &successor = this->successors[i];
+                double path_cost = node_cost + successor.cost;
+                auto slot = static_cast<std::uint32_t>(best_g.size());
+                auto [known, inserted] = best_g.try_emplace(successor.state, Record{path_cost, slot, false, UNEVALUATED});
+                if (inserted && heuristic_weight == 0) {
+                    known->second.h = 0.0;
+                } else if (!inserted) {
+                    // Only a strictly cheaper path is worth queueing; it reopens the state if it was closed
+                    if (path_cost >= known->second.g) {
+                        this->statistics.count_duplicate();
+                        continue;
+                    }
+                    known->second.g = path_cost;
+                    known->second.closed = false;
+                }
+                if (std::isnan(known->second.h)) {
+                    if (i != fresh) {
+                        std::swap(this->successors[fresh], successor);
+                    }
+                    fresh++;
+                    pending.push_back(Pending{&known->second, path_cost});
+                    continue;
+                }
+                push(open, node, successor, path_cost, known->second);
+            }
+            this->heuristics(this->successors.first(fresh), this->estimates, this->statistics);
+            for (std::size_t i = 0; i < fresh; i++) {
+                Record &record = *pending[i].record;
+                record.h = heuristic_weight * this->estimates[i];
+                push(open, node, this->successors[i], pending[i].g, record);
+            }
+            this->statistics.track_frontier(open.size());
+        }
+        return this->finish(NO_NODE, sizeof(FrontierEntry));
+    }
+
+    template <class Frontier>
+    void push(Frontier &open, NodeId parent, Successor<typename P::state_type> &successor, double path_cost, const Record &record) {
+        NodeId child = this->add_child(parent, successor, path_cost, record.h);
+        PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+        open.push(child, record.slot, path_cost + record.h, record.h);
+    }
+};
+
+/**
+ * @brief Uniform-cost (Dijkstra) search over a problem known at compile time.
+ *
+ * Shares the A* machinery with a zero heuristic weight: nodes are ordered by path cost alone and the heuristic is never evaluated.
+ * Optimal for non-negative action costs; the goal is returned as soon as it is popped.
+ */
+template <SearchProblem P>
+class UniformCost : public AStar<P> {
+public:
+    explicit UniformCost(const P &problem, FrontierKind frontier = FrontierKind::AUTO) : AStar<P>(problem, frontier) {
+        this->heuristic_weight = 0.0;
+    }
+};
+
+#endif // ENGINE_ASTAR_H
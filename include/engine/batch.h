@@ -0,0 +1,154 @@
+/**
+ * @file batch.h
+ * @brief Solving many independent problem instances on a work-stealing thread pool, one reused engine per worker.
+ */
+
+#ifndef ENGINE_BATCH_H
+#define ENGINE_BATCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "engine.h"
+#include "../work_stealing_pool.h"
+
+/**
+ * @brief A problem that forwards every member to whichever instance it currently points at.
+ *
+ * Engines keep a reference to their problem for life; pointing one at a slot lets it solve a whole batch of instances in turn,
+ * with its arena, tables and frontier reused between them. Forwards what ProblemAdapter does, and h_batch as well since the slot
+ * does not replace h().
+ */
+template <SearchProblem P>
+class ProblemSlot : public ProblemAdapter<P> {
+public:
+    using state_type = typename P::state_type;
+
+    ProblemSlot() = default;
+
+    /// Makes the following calls go to problem, which must outlive the searches run on it.
+    void point_at(const P &problem) { this->target = &problem; }
+
+    /// The instance the slot points at.
+    const P &current() const { return *this->target; }
+
+    void h_batch(std::span<const Successor<state_type>> successors, std::span<double> out) const requires BatchHeuristicProblem<P> {
+        this->target->h_batch(successors, out);
+    }
+};
+
+/**
+ * @brief Outcome of one instance of a batch.
+ */
+template <class R>
+struct BatchResult {
+    R solution;         ///< What the batch's extract function made of the search, e.g. the path
+    SearchStats stats;  ///< Statistics of the instance's search
+};
+
+/**
+ * @brief Totals and throughput of a batch.
+ */
+struct BatchSummary {
+    std::size_t instances = 0;
+    std::size_t solved = 0;
+    std::uint64_t expanded = 0;    ///< Expansions over all instances
+    std::uint64_t generated = 0;   ///< Generated nodes over all instances
+    double seconds = 0.0;          ///< Wall-clock time of the whole batch
+    double search_seconds = 0.0;   ///< Sum of the instances' own search times
+    unsigned threads = 0;          ///< Workers of the pool that ran the batch
+
+    double instances_per_second() const { return seconds > 0 ? static_cast<double>(instances) / seconds : 0.0; }
+
+    double expansions_per_second() const { return seconds > 0 ? static_cast<double>(expanded) / seconds : 0.0; }
+
+    /// Share of the workers' time spent searching rather than idle or setting up, between 0 and 1.
+    double utilization() const { return seconds > 0 && threads > 0 ? search_seconds / (seconds * threads) : 0.0; }
+};
+
+/**
+ * @brief Per-instance results, in input order, and the batch's totals.
+ */
+template <class R>
+struct BatchReport {
+    std::vector<BatchResult<R>> results;
+    BatchSummary summary;
+};
+
+/**
+ * @brief Solves every instance of a batch on a thread pool, reusing one engine per worker.
+ *
+ * Each worker creates its engine once, with make_engine(slot), on the first instance it takes, and then points the slot at every
+ * instance it runs, so node arenas, tables and frontiers keep their memory from one instance to the next (A* and BFS keep all three).
+ * Set limits and options on the engine in make_engine: a CancellationToken in its limits then stops the whole batch.
+ * While an instance's nodes are still in the engine, extract(engine, goal, instance) turns the outcome into its result;
+ * it runs on the worker threads and must return a default-constructible value.
+ *
+ * @param pool The pool to run on; the batch takes all its workers until it returns.
+ * @param problems The instances, by pointer since problems are rarely copyable; they must stay alive and unchanged until the call returns.
+ * @param make_engine Called with a `const ProblemSlot<P> &`, returns an engine over it by value, e.g. `[](const auto &slot) { return AStar(slot); }`.
+ * @param extract Called as `extract(engine, goal, instance)` after every search.
+ * @return The results in input order, and the totals.
+ * @throws Whatever a search or extract throws; the batch stops handing out instances and rethrows the first exception.
+ */
+template <SearchProblem P, class MakeEngine, class Extract>
+auto solve_batch(WorkStealingPool &pool, std::span<const P *const> problems, MakeEngine make_engine, Extract extract) {
+    using Engine = std::invoke_result_t<MakeEngine &, const ProblemSlot<P> &>;
+    using Result = std::decay_t<std::invoke_result_t<Extract &, const Engine &, NodeId, const P &>>;
+    struct Workspace {
+        ProblemSlot<P> slot;
+        std::unique_ptr<Engine> engine;
+    };
+
+    BatchReport<Result> report;
+    report.results.resize(problems.size());
+    std::vector<Workspace> workspaces(pool.size());
+    auto started = std::chrono::steady_clock::now();
+    pool.run(problems.size(), [&](unsigned worker, std::size_t index) {
+        Workspace &workspace = workspaces[worker];
+        workspace.slot.point_at(*problems[index]);
+        if (!workspace.engine) {
+            // Constructed in place from make_engine's result, so engines need not be movable
+            workspace.engine.reset(new Engine(make_engine(workspace.slot)));
+        }
+        NodeId goal = workspace.engine->search();
+        BatchResult<Result> &result = report.results[index];
+        result.stats = workspace.engine->stats();
+        result.solution = extract(*workspace.engine, goal, *problems[index]);
+    });
+
+    BatchSummary &summary = report.summary;
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    summary.instances = problems.size();
+    summary.threads = pool.size();
+    for (const auto &result : report.results) {
+        summary.solved += result.stats.solved ? 1 : 0;
+        summary.expanded += result.stats.expanded;
+        summary.generated += result.stats.generated;
+        summary.search_seconds += result.stats.search_seconds;
+    }
+    return report;
+}
+
+/**
+ * @brief Solves a batch and returns the states on each solution path, from the initial state to the goal (empty if unsolved).
+ */
+template <SearchProblem P, class MakeEngine>
+auto solve_batch(WorkStealingPool &pool, std::span<const P *const> problems, MakeEngine make_engine) {
+    return solve_batch(pool, problems, make_engine, [](const auto &engine, NodeId goal, const P &) {
+        std::vector<typename P::state_type> path;
+        if (goal != NO_NODE) {
+            for (const auto *node : engine.path(goal)) {
+                path.push_back(node->state);
+            }
+        }
+        return path;
+    });
+}
+
+#endif // ENGINE_BATCH_H
@@ -0,0 +1,140 @@
+/**
+ * @file beam.h
+ * @brief Compile-time specialized beam search.
+ */
+
+#ifndef ENGINE_BEAM_H
+#define ENGINE_BEAM_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief Beam search over a problem known at compile time.
+ *
+ * Each layer keeps only the beam_width nodes with the lowest f(n). Incomplete and sub-optimal.
+ * Children are collected as candidates and only the selected ones are stored as nodes, so the arena grows with the beam and not with the layers.
+ *
+ * - By default the whole layer is gathered and the best beam_width candidates are picked with a linear-time selection.
+ * - With bounded_layer, a max-heap of beam_width candidates is maintained as children are generated, so the layer never holds more than beam_width entries.
+ * - With deduplicate, children with a state already present in the layer are merged, keeping the lower f.
+ */
+template <SearchProblem P>
+class Beam : public EngineBase<P> {
+public:
+    Beam(const P &problem, int beam_width, bool deduplicate = false, bool bounded_layer = false)
+        : EngineBase<P>(problem), beam_width(beam_width), deduplicate(deduplicate), bounded_layer(bounded_layer) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if the beam ran dry.
+     */
+    NodeId search() {
+        this->begin_search();
+        std::vector<NodeId> beam{this->add_root()};
+        auto width = static_cast<std::size_t>(std::max(beam_width, 1));
+        std::unordered_map<typename P::state_type, std::uint32_t, ProblemHash<P>, ProblemEqual<P>> in_layer(
+            0, ProblemHash<P>{&this->problem}, ProblemEqual<P>{&this->problem});
+
+        while (!beam.empty()) {
+            layer.clear();
+            worst_first.clear();
+            in_layer.clear();
+
+            for (NodeId node : beam) {
+                if (this->problem.is_goal(this->arena[node].state)) {
+                    return this->finish(node, sizeof(Candidate));
+                }
+                if (this->out_of_budget(this->arena[node].path_cost + this->arena[node].heuristic,
+                                        layer.size() * sizeof(Candidate) + beam.size() * sizeof(NodeId))) {
+                    return this->finish(NO_NODE, sizeof(Candidate));
+                }
+                this->expand(node);
+                this->heuristics(this->successors.all(), this->estimates, this->statistics);
+                double path_cost = this->arena[node].path_cost;
+                for (std::size_t i = 0; i < this->successors.size(); i++) {
+                    double g = path_cost + this->successors[i].cost;
+                    double h = this->estimates[i];
+                    offer(in_layer, width, Candidate{g + h, g, h, node, std::move(this->successors[i])});
+                }
+            }
+
+            this->statistics.track_frontier(layer.size());
+            if (!bounded_layer && layer.size() > width) {
+                std::nth_element(layer.begin(), layer.begin() + width, layer.end(), [](const Candidate &a, const Candidate &b) {
+                    return a.f < b.f || (a.f == b.f && a.h < b.h);
+                });
+                layer.erase(layer.begin() + width, layer.end());
+            }
+
+            beam.clear();
+            for (auto &candidate : layer) {
+                beam.push_back(this->add_child(candidate.parent, candidate.successor, candidate.g, candidate.h));
+            }
+        }
+        return this->finish(NO_NODE, sizeof(Candidate));
+    }
+
+    int beam_width;
+    bool deduplicate;
+    bool bounded_layer;
+
+private:
+    struct Candidate {
+        double f;
+        double g;
+        double h;
+        NodeId parent;
+        Successor<typename P::state_type> successor;
+    };
+
+    std::vector<Candidate> layer;
+    IndexedHeapFrontier worst_first; // Layer slots keyed on -f, so the top is the worst kept candidate
+
+    template <class Index>
+    void offer(Index &in_layer, std::size_t width, Candidate &&candidate) {
+        if (deduplicate) {
+            auto known = in_layer.find(candidate.successor.state);
+            if (known != in_layer.end()) {
+                this->statistics.count_duplicate();
+                std::uint32_t slot = known->second;
+                if (candidate.f < layer[slot].f) {
+                    layer[slot] = std::move(candidate);
+                    if (bounded_layer) {
+                        worst_first.push(slot, slot, -layer[slot].f, -layer[slot].h);
+                    }
+                }
+                return;
+            }
+        }
+
+        std::uint32_t slot;
+        if (!bounded_layer || layer.size() < width) {
+            slot = static_cast<std::uint32_t>(layer.size());
+            layer.push_back(std::move(candidate));
+        } else {
+            // Full layer: the candidate only gets in by evicting the worst one
+            slot = worst_first.top();
+            if (candidate.f >= layer[slot].f) {
+                return;
+            }
+            worst_first.pop();
+            if (deduplicate) {
+                in_layer.erase(layer[slot].successor.state);
+            }
+            layer[slot] = std::move(candidate);
+        }
+        if (bounded_layer) {
+            worst_first.push(slot, slot, -layer[slot].f, -layer[slot].h);
+        }
+        if (deduplicate) {
+            in_layer.emplace(layer[slot].successor.state, slot);
+        }
+    }
+};
+
+#endif // ENGINE_BEAM_H
@@ -0,0 +1,75 @@
+/**
+ * @file bfs.h
+ * @brief Compile-time specialized breadth-first search.
+ */
+
+#ifndef ENGINE_BFS_H
+#define ENGINE_BFS_H
+
+#include <vector>
+#include "engine.h"
+#include "../visited_set.h"
+
+/**
+ * @brief Breadth-first search over a problem known at compile time.
+ *
+ * Duplicates are detected when a child is generated, so each state enters the frontier at most once.
+ * The order ignores the heuristic, so it is never evaluated and nodes record 0. The frontier and the visited set keep their memory
+ * between searches.
+ */
+template <SearchProblem P>
+class BFS : public EngineBase<P> {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param eliminate_duplicates Skip children whose state was already generated.
+     */
+    explicit BFS(const P &problem, bool eliminate_duplicates = true)
+        : EngineBase<P>(problem), eliminate_duplicates(eliminate_duplicates) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        this->begin_search();
+        frontier.clear();
+        visited.clear();
+        NodeId root = this->add_root(0.0);
+        if (eliminate_duplicates) {
+            visited.insert(this->arena[root].state);
+        }
+        frontier.push_back(root);
+        for (std::size_t next = 0; next < frontier.size(); next++) {
+            NodeId node = frontier[next];
+
+            if (this->problem.is_goal(this->arena[node].state)) {
+                return this->finish(node, sizeof(NodeId));
+            }
+            double path_cost = this->arena[node].path_cost;
+            if (this->out_of_budget(path_cost, visited.memory_usage() + frontier.size() * sizeof(NodeId))) {
+                return this->finish(NO_NODE, sizeof(NodeId));
+            }
+            this->expand(node);
+            for (auto &successor : this->successors) {
+                if (eliminate_duplicates && !visited.insert(successor.state)) {
+                    this->statistics.count_duplicate();
+                    continue;
+                }
+                frontier.push_back(this->add_child(node, successor, path_cost + successor.cost, 0.0));
+            }
+            this->statistics.track_frontier(frontier.size() - next - 1);
+        }
+        return this->finish(NO_NODE, sizeof(NodeId));
+    }
+
+    bool eliminate_duplicates;
+
+private:
+    // Kept between searches, so a reused engine does not allocate them again
+    std::vector<NodeId> frontier;  // Every node queued so far, in FIFO order
+    VisitedSet<P> visited{this->problem};
+};
+
+#endif // ENGINE_BFS_H
@@ -0,0 +1,235 @@
+/**
+ * @file bidirectional.h
+ * @brief Compile-time specialized bidirectional best-first search.
+ */
+
+#ifndef ENGINE_BIDIRECTIONAL_H
+#define ENGINE_BIDIRECTIONAL_H
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief Front-to-end bidirectional A* over a problem that exposes predecessors.
+ *
+ * One best-first search runs forward from the initial state towards the goal with h, and one runs backward from the goal over
+ * predecessors with h_reverse (or 0 when the problem does not provide it). The side with the smaller open list is expanded next.
+ * Whenever a side generates a state the other side has reached, the combined path cost is a candidate solution.
+ *
+ * The search stops once the best candidate costs no more than a lower bound on any path not yet found:
+ * max(min f forward, min f backward) with heuristics, or min g forward + min g backward without them (bidirectional Dijkstra).
+ * The result is optimal for non-negative costs and consistent heuristics.
+ *
+ * The two halves are then spliced: the backward half is appended to the arena as forward nodes, so path(goal) reads from the initial state to the goal.
+ * For integral-cost problems h_reverse must be integral too, as both sides use the same frontier kind.
+ */
+template <BidirectionalProblem P>
+class Bidirectional : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem to solve.
+     * @param use_heuristic Guide both sides with their heuristics; false runs bidirectional uniform-cost search.
+     * @param frontier The priority queue each side uses.
+     */
+    explicit Bidirectional(const P &problem, bool use_heuristic = true, FrontierKind frontier = FrontierKind::AUTO)
+        : EngineBase<P>(problem), use_heuristic(use_heuristic), frontier(frontier) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        FrontierKind kind = frontier;
+        if (kind == FrontierKind::AUTO) {
+            kind = declares_integral_costs(this->problem) ? FrontierKind::BUCKET : FrontierKind::INDEXED_HEAP;
+        }
+        switch (kind) {
+            case FrontierKind::BUCKET:
+                return run<BucketFrontier>();
+            case FrontierKind::BINARY_HEAP:
+                return run<BinaryHeapFrontier>();
+            default:
+                return run<IndexedHeapFrontier>();
+        }
+    }
+
+    /// Nodes expanded by the last search, both directions together.
+    std::size_t expansions() const { return expanded; }
+
+    bool use_heuristic;
+    FrontierKind frontier;
+
+private:
+    struct Record {
+        double g;
+        std::uint32_t slot;
+        bool closed;
+        NodeId node;  // Node holding the cheapest known path
+        double h;     // Estimate for this side, evaluated once per state
+    };
+
+    template <class Frontier>
+    struct Side {
+        explicit Side(const P &problem) : best_g(0, ProblemHash<P>{&problem}, ProblemEqual<P>{&problem}) {}
+        Frontier open;
+        std::unordered_map<state_type, Record, ProblemHash<P>, ProblemEqual<P>> best_g;
+        bool backward = false;
+    };
+
+    std::size_t expanded = 0;
+
+    double estimate(const state_type &state, bool backward) {
+        if (!use_heuristic) {
+            return 0.0;
+        }
+        if (!backward) {
+            return this->heuristic(state);
+        }
+        if constexpr (requires { { this->problem.h_reverse(state) } -> std::convertible_to<double>; }) {
+            PhaseTimer timer(this->statistics.heuristic_seconds, this->phase_timers);
+            this->statistics.count_heuristic();
+            return this->problem.h_reverse(state);
+        } else {
+            return 0.0;
+        }
+    }
+
+    /// Pops stale entries so the top of the open list is a live node.
+    template <class Frontier>
+    void settle(Side<Frontier> &side) {
+        while (!side.open.empty()) {
+            // Peek by popping and pushing back: frontiers only expose the top f, not the top node
+            PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+            NodeId node = side.open.pop();
+            const auto &record = this->arena[node];
+            Record &best = side.best_g.find(record.state)->second;
+            if (record.path_cost > best.g || best.closed) {
+                continue;
+            }
+            side.open.push(node, best.slot, record.path_cost + record.heuristic, record.heuristic);
+            return;
+        }
+    }
+
+    template <class Frontier>
+    NodeId run() {
+        this->begin_search();
+        expanded = 0;
+        this->arena.clear();
+        Side<Frontier> sides[2]{Side<Frontier>(this->problem), Side<Frontier>(this->problem)};
+        sides[1].backward = true;
+
+        state_type start = this->problem.initial();
+        state_type goal = this->problem.goal();
+        if (this->problem.equal(start, goal)) {
+            double heuristic = estimate(start, false);
+            return this->finish(this->arena.emplace(std::move(start), 0.0, heuristic, NO_NODE, ActionId{0}), sizeof(FrontierEntry));
+        }
+        for (int s = 0; s < 2; s++) {
+            state_type state = s ? goal : start;
+            double heuristic = estimate(state, s == 1);
+            NodeId root = this->arena.emplace(std::move(state), 0.0, heuristic, NO_NODE, ActionId{0});
+            sides[s].best_g.emplace(this->arena[root].state, Record{0.0, 0, false, root, heuristic});
+            sides[s].open.push(root, 0, heuristic, heuristic);
+        }
+
+        double best = std::numeric_limits<double>::infinity();
+        NodeId meet[2] = {NO_NODE, NO_NODE};  // Forward and backward nodes of the best candidate
+
+        while (true) {
+            settle(sides[0]);
+            settle(sides[1]);
+            if (sides[0].open.empty() || sides[1].open.empty()) {
+                break;
+            }
+            double forward_min = sides[0].open.top_f();
+            double backward_min = sides[1].open.top_f();
+            double bound = use_heuristic ? std::max(forward_min, backward_min) : forward_min + backward_min;
+            if (best <= bound) {
+                break;
+            }
+            if (this->out_of_budget(bound, (sides[0].open.size() + sides[1].open.size()) * sizeof(FrontierEntry))) {
+                return this->finish(NO_NODE, sizeof(FrontierEntry));
+            }
+
+            int s = sides[0].open.size() <= sides[1].open.size() ? 0 : 1;
+            Side<Frontier> &side = sides[s];
+            Side<Frontier> &other = sides[1 - s];
+
+            NodeId node;
+            {
+                PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+                node = side.open.pop();
+            }
+            double node_cost = this->arena[node].path_cost;
+            side.best_g.find(this->arena[node].state)->second.closed = true;
+            expanded++;
+
+            this->successors.clear();
+            if (side.backward) {
+                PhaseTimer timer(this->statistics.expand_seconds, this->phase_timers);
+                this->problem.predecessors(this->arena[node].state, this->successors);
+                this->statistics.count_expansion(this->successors.size());
+            } else {
+                this->expand(node);
+            }
+            for (auto &successor : this->successors) {
+                double path_cost = node_cost + successor.cost;
+                auto slot = static_cast<std::uint32_t>(side.best_g.size());
+                auto [known, inserted] = side.best_g.try_emplace(successor.state, Record{path_cost, slot, false, NO_NODE, 0.0});
+                if (inserted) {
+                    known->second.h = estimate(successor.state, side.backward);
+                } else {
+                    if (path_cost >= known->second.g) {
+                        this->statistics.count_duplicate();
+                        continue;
+                    }
+                    known->second.g = path_cost;
+                    known->second.closed = false;
+                    slot = known->second.slot;
+                }
+                auto reached = other.best_g.find(successor.state);
+                double heuristic = known->second.h;
+                NodeId child = this->add_child(node, successor, path_cost, heuristic);
+                known->second.node = child;
+                if (reached != other.best_g.end() && path_cost + reached->second.g < best) {
+                    best = path_cost + reached->second.g;
+                    meet[s] = child;
+                    meet[1 - s] = reached->second.node;
+                }
+                PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+                side.open.push(child, slot, path_cost + heuristic, heuristic);
+            }
+            this->statistics.track_frontier(sides[0].open.size() + sides[1].open.size());
+        }
+
+        if (meet[0] == NO_NODE) {
+            return this->finish(NO_NODE, sizeof(FrontierEntry));
+        }
+        return this->finish(splice(meet[0], meet[1]), sizeof(FrontierEntry));
+    }
+
+    /// Appends the backward half after the forward node it meets, turning it into forward nodes that end at the goal.
+    NodeId splice(NodeId forward, NodeId backward) {
+        NodeId last = forward;
+        for (NodeId from = backward; this->arena[from].parent != NO_NODE; from = this->arena[from].parent) {
+            // A backward node's action leads from its own state to its parent's
+            const auto &step = this->arena[from];
+            const auto &next = this->arena[step.parent];
+            double path_cost = this->arena[last].path_cost + (step.path_cost - next.path_cost);
+            state_type state = next.state;
+            double heuristic = estimate(state, false);
+            last = this->arena.emplace(std::move(state), path_cost, heuristic, last, step.action);
+        }
+        return last;
+    }
+};
+
+#endif // ENGINE_BIDIRECTIONAL_H
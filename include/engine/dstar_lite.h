@@ -0,0 +1,314 @@
+/**
+ * @file dstar_lite.h
+ * @brief Compile-time specialized incremental replanning with D* Lite.
+ */
+
+#ifndef ENGINE_DSTAR_LITE_H
+#define ENGINE_DSTAR_LITE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief D* Lite: A* that keeps its work between searches and repairs it after the problem changes.
+ *
+ * Searches backward from the problem's goal() over predecessors(), keeping for every state reached its goal distance g and a
+ * one-step lookahead rhs computed from its successors. A state whose g and rhs disagree is queued, and a search stops as soon as the
+ * start is consistent and no queued state could shorten its path. The first search explores like backward A* with h_reverse, except
+ * that ties in f go to states nearer the goal, as the algorithm requires; on problems with many optimal paths, such as open grids,
+ * it can expand several times more states than A*.
+ *
+ * Between searches, the problem may change the cost of its actions, add or remove them, and move its initial state. Changes are
+ * reported with changed(), which recomputes rhs for the state and for its current predecessors and successors. When actions are
+ * reversible, as in a grid, those are all the states whose actions can have changed, so reporting each cell that opened or closed is
+ * enough; otherwise report every state whose outgoing actions changed. predecessors() must be the exact inverse of expand().
+ * The next search() then repairs only the distances that really changed, so
+ * the work of a replan grows with how much the answer changes rather than with the size of the problem. A moved start only shifts
+ * the priorities by the heuristic distance between the old and new start (the "key modifier"), as in Koenig and Likhachev's algorithm.
+ * With the start fixed, it is LPA* searching from the goal.
+ *
+ * h_reverse (0 if the problem lacks it) must be consistent. A different goal() starts over. A search stopped by one of its limits
+ * returns NO_NODE but keeps its work, so the next search() continues where it stopped. The returned path is rebuilt from
+ * the distances on every search, and its nodes store the remaining cost to the goal as their heuristic.
+ */
+template <BidirectionalProblem P>
+class DStarLite : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+
+    explicit DStarLite(const P &problem) : EngineBase<P>(problem) {}
+
+    /**
+     * @brief Computes (or repairs) the goal distances from the current initial state and extracts its path.
+     *
+     * @return The goal node in nodes(), which holds only the path, or NO_NODE if the goal cannot be reached.
+     */
+    NodeId search() {
+        this->begin_search();
+        this->arena.clear();
+        peak_open = open.size();
+        state_type goal = this->problem.goal();
+        if (records.empty() || !this->problem.equal(*records[GOAL].state, goal)) {
+            reset();
+            std::uint32_t slot = lookup(std::move(goal));
+            records[slot].rhs = 0.0;
+            enqueue(slot);
+        }
+        state_type start = this->problem.initial();
+        std::uint32_t start_slot = find(start);
+        if (start_slot != last_start && last_start != NONE) {
+            // Queued keys used the old start's heuristic; raising every future key by the distance moved keeps them lower bounds
+            key_modifier += reverse_h(*records[last_start].state);
+        }
+
+        if (!improve(start)) {
+            return this->finish(NO_NODE);
+        }
+
+        start_slot = find(start);
+        last_start = start_slot;
+        this->statistics.peak_nodes = records.size();
+        this->statistics.peak_memory = records.size() * (sizeof(Record) + sizeof(state_type) + sizeof(std::uint32_t) + 2 * sizeof(void *))
+                                       + peak_open * sizeof(FrontierEntry);
+        if (start_slot == NONE || records[start_slot].g == INF) {
+            return this->finish(NO_NODE);
+        }
+        return this->finish(extract(std::move(start), start_slot));
+    }
+
+    /**
+     * @brief Reports that actions into or out of a state changed since the last search.
+     *
+     * Marks the state, its predecessors and its successors for repair; the work happens in the next search().
+     * Successors are included for reversible problems: a grid cell that closed has no predecessors left, but the neighbours
+     * that lost their move into it are still its successors. Has no effect before the first search.
+     */
+    void changed(const state_type &state) {
+        if (records.empty()) {
+            return;
+        }
+        // Collected first, as update() reuses the buffers
+        affected.clear();
+        affected.push_back(lookup(state));
+        predecessors_of(state);
+        this->expand(state, this->successors, this->statistics);
+        for (std::size_t i = 0; i < this->successors.size(); i++) {
+            affected.push_back(lookup(std::move(this->successors[i].state)));
+        }
+        for (std::uint32_t slot : affected) {
+            update(slot);
+        }
+    }
+
+    /// Reports a batch of changed states, e.g. every cell toggled since the last search.
+    void changed(std::span<const state_type> states) {
+        for (const state_type &state : states) {
+            changed(state);
+        }
+    }
+
+    /// Forgets all distances, so the next search starts from scratch.
+    void reset() {
+        records.clear();
+        slots.clear();
+        open.clear();
+        key_modifier = 0.0;
+        last_start = NONE;
+    }
+
+    /// States with a goal distance or lookahead kept between searches.
+    std::size_t size() const { return records.size(); }
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+    static constexpr std::uint32_t NONE = ~std::uint32_t(0);
+    static constexpr std::uint32_t GOAL = 0;
+
+    struct Key {
+        double primary;    // min(g, rhs) + h + key modifier
+        double secondary;  // min(g, rhs)
+
+        bool operator<(const Key &other) const {
+            return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+        }
+    };
+
+    struct Record {
+        double g;                // Goal distance, as of the last time the state was made consistent
+        double rhs;              // Cheapest action cost plus successor's g; the goal's is 0
+        Key key;                 // Priority the state was last queued with
+        const state_type *state; // Key of the state in slots, stable while it is kept
+    };
+
+    std::vector<Record> records;
+    std::unordered_map<state_type, std::uint32_t, ProblemHash<P>, ProblemEqual<P>> slots{
+        0, ProblemHash<P>{&this->problem}, ProblemEqual<P>{&this->problem}};
+    IndexedHeapFrontier open;  // Queued slots, keyed by (primary, secondary); consistent entries are skipped when popped
+    SuccessorBuffer<state_type> children;
+    std::vector<std::uint32_t> affected;  // Slots changed() updates
+    double key_modifier = 0.0;
+    std::uint32_t last_start = NONE;
+    std::size_t peak_open = 0;  // Largest queue of the current search, kept whether or not stats are compiled in
+
+    std::uint32_t find(const state_type &state) const {
+        auto found = slots.find(state);
+        return found == slots.end() ? NONE : found->second;
+    }
+
+    std::uint32_t lookup(state_type state) {
+        auto next = static_cast<std::uint32_t>(records.size());
+        auto [found, inserted] = slots.try_emplace(std::move(state), next);
+        if (inserted) {
+            records.push_back(Record{INF, INF, Key{INF, INF}, &found->first});
+        }
+        return found->second;
+    }
+
+    double g_of(const state_type &state) const {
+        std::uint32_t slot = find(state);
+        return slot == NONE ? INF : records[slot].g;
+    }
+
+    double reverse_h(const state_type &state) {
+        if constexpr (requires { { this->problem.h_reverse(state) } -> std::convertible_to<double>; }) {
+            this->statistics.count_heuristic();
+            return this->problem.h_reverse(state);
+        } else {
+            return 0.0;
+        }
+    }
+
+    Key key(std::uint32_t slot) {
+        double distance = std::min(records[slot].g, records[slot].rhs);
+        return Key{distance + reverse_h(*records[slot].state) + key_modifier, distance};
+    }
+
+    void enqueue(std::uint32_t slot) {
+        Key priority = key(slot);
+        records[slot].key = priority;
+        PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+        open.push(slot, slot, priority.primary, priority.secondary);
+    }
+
+    /// Fills the successor buffer with the predecessors of a state.
+    void predecessors_of(const state_type &state) {
+        PhaseTimer timer(this->statistics.expand_seconds, this->phase_timers);
+        this->successors.clear();
+        this->problem.predecessors(state, this->successors);
+        this->statistics.count_expansion(this->successors.size());
+    }
+
+    /// Recomputes rhs of a state from its successors, and queues it if that leaves it inconsistent.
+    void update(std::uint32_t slot) {
+        if (slot != GOAL) {
+            children.clear();
+            this->expand(*records[slot].state, children, this->statistics);
+            double rhs = INF;
+            for (std::size_t i = 0; i < children.size(); i++) {
+                rhs = std::min(rhs, children[i].cost + g_of(children[i].state));
+            }
+            records[slot].rhs = rhs;
+        }
+        if (records[slot].g != records[slot].rhs) {
+            enqueue(slot);
+        }
+    }
+
+    /// Processes inconsistent states in key order until the start's distance is settled; false if a limit stopped it first.
+    bool improve(const state_type &start) {
+        while (!open.empty()) {
+            std::uint32_t start_slot = find(start);
+            Key start_key = start_slot == NONE ? Key{INF, INF} : key(start_slot);
+            bool start_consistent = start_slot == NONE || records[start_slot].g == records[start_slot].rhs;
+            std::uint32_t slot = static_cast<std::uint32_t>(open.top());
+            if (!(records[slot].key < start_key) && start_consistent) {
+                break;
+            }
+            if (this->out_of_budget(records[slot].key.primary - key_modifier,
+                                    records.size() * (sizeof(Record) + sizeof(state_type)) + open.size() * sizeof(FrontierEntry))) {
+                return false;
+            }
+            {
+                PhaseTimer timer(this->statistics.queue_seconds, this->phase_timers);
+                open.pop();
+            }
+            if (records[slot].g == records[slot].rhs) {
+                continue;
+            }
+            Key current = key(slot);
+            if (records[slot].key < current) {
+                enqueue(slot);
+                continue;
+            }
+
+            double old_g = records[slot].g;
+            bool lowered = records[slot].g > records[slot].rhs;
+            if (lowered) {
+                records[slot].g = records[slot].rhs;
+            } else {
+                records[slot].g = INF;
+                update(slot);
+            }
+            double g = records[slot].g;
+            predecessors_of(*records[slot].state);
+            for (std::size_t i = 0; i < this->successors.size(); i++) {
+                double cost = this->successors[i].cost;
+                std::uint32_t predecessor = lookup(std::move(this->successors[i].state));
+                if (predecessor == GOAL) {
+                    continue;
+                }
+                if (lowered) {
+                    // A shorter distance can only lower rhs, through this action
+                    if (cost + g < records[predecessor].rhs) {
+                        records[predecessor].rhs = cost + g;
+                        enqueue(predecessor);
+                    }
+                } else if (records[predecessor].rhs == cost + old_g) {
+                    // rhs came through this state, whose distance grew: look at all the successors again
+                    update(predecessor);
+                }
+            }
+            this->statistics.track_frontier(open.size());
+            peak_open = std::max(peak_open, open.size());
+        }
+        return true;
+    }
+
+    /// Builds the path from the start by always taking the action to the successor closest to the goal.
+    NodeId extract(state_type start, std::uint32_t start_slot) {
+        NodeId node = this->arena.emplace(std::move(start), 0.0, records[start_slot].g, NO_NODE, ActionId{0});
+        double path_cost = 0.0;
+        for (std::size_t steps = 0; !this->problem.equal(this->arena[node].state, *records[GOAL].state); steps++) {
+            if (steps == records.size()) {
+                return NO_NODE;  // Distances that do not lead to the goal; only an inconsistent heuristic gets here
+            }
+            children.clear();
+            this->expand(this->arena[node].state, children, this->statistics);
+            std::size_t best = children.size();
+            double best_cost = INF;
+            for (std::size_t i = 0; i < children.size(); i++) {
+                double through = children[i].cost + g_of(children[i].state);
+                if (through < best_cost) {
+                    best = i;
+                    best_cost = through;
+                }
+            }
+            if (best == children.size()) {
+                return NO_NODE;
+            }
+            path_cost += children[best].cost;
+            double remaining = g_of(children[best].state);
+            node = this->add_child(node, children[best], path_cost, remaining);
+        }
+        return node;
+    }
+};
+
+#endif // ENGINE_DSTAR_LITE_H
@@ -0,0 +1,513 @@
+/**
+ * @file engine.h
+ * @brief Building blocks shared by the compile-time specialized search engines.
+ *
+ * The engines in this directory are templates over a concrete problem type, so state and action types are known at compile time,
+ * goal tests, expansions and heuristics are direct (inlinable) calls, and no virtual dispatch or casting happens per node.
+ * Problems written against the abstract Problem class run through the same engines via VirtualProblem.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "../definitions.h"
+#include "../node_arena.h"
+#include "../search_limits.h"
+#include "../stats.h"
+#include "frontier.h"
+
+/**
+ * @brief Requirements on a problem solved by the templated engines.
+ *
+ * A problem exposes its concrete `state_type` and provides:
+ * - `initial()` returning the start state,
+ * - `is_goal(state)`,
+ * - `h(state)`, the heuristic estimate,
+ * - `hash(state)` and `equal(a, b)`, describing state identity for duplicate detection,
+ * - `expand(state, out)`, emplacing the successors of a state into an engine-owned SuccessorBuffer.
+ *
+ * There is no action type to declare: actions are identified by interned ActionId values, and problems usually also provide
+ * `action_name(id)` to report paths.
+ * Problems may additionally provide `bool pack(const state_type &, std::uint64_t &)` to enable compact visited sets,
+ * `bool integral_costs()` to declare integer costs and heuristics, and `h_batch` (see BatchHeuristicProblem).
+ */
+template <class P>
+concept SearchProblem = requires(const P &problem,
+                                 const typename P::state_type &state,
+                                 SuccessorBuffer<typename P::state_type> &out) {
+    { problem.initial() } -> std::convertible_to<typename P::state_type>;
+    { problem.is_goal(state) } -> std::convertible_to<bool>;
+    { problem.h(state) } -> std::convertible_to<double>;
+    { problem.hash(state) } -> std::convertible_to<std::size_t>;
+    { problem.equal(state, state) } -> std::convertible_to<bool>;
+    problem.expand(state, out);
+};
+
+/**
+ * @brief Problems whose states can be packed into 64-bit keys.
+ */
+template <class P>
+concept PackableProblem = SearchProblem<P> && requires(const P &problem, const typename P::state_type &state, std::uint64_t &key) {
+    { problem.pack(state, key) } -> std::convertible_to<bool>;
+};
+
+/**
+ * @brief Problems that evaluate the heuristic of a run of successors in one call.
+ *
+ * `h_batch(successors, out)` writes h of each successor's state to out, in order. Engines call it once per expansion
+ * instead of h() once per child, which lets the problem gather the states into arrays and use vector instructions.
+ */
+template <class P>
+concept BatchHeuristicProblem = SearchProblem<P> && requires(const P &problem,
+                                                             std::span<const Successor<typename P::state_type>> successors,
+                                                             std::span<double> out) {
+    problem.h_batch(successors, out);
+};
+
+/**
+ * @brief Problems that can also be searched backward from a single goal state.
+ *
+ * `goal()` returns the goal state and `predecessors(state, out)` emits every state with an action leading to `state`,
+ * tagged with that forward action and its cost. Problems may also provide `h_reverse(state)`, an admissible estimate of the cost
+ * from the initial state to `state`.
+ */
+template <class P>
+concept BidirectionalProblem = SearchProblem<P> && requires(const P &problem,
+                                                            const typename P::state_type &state,
+                                                            SuccessorBuffer<typename P::state_type> &out) {
+    { problem.goal() } -> std::convertible_to<typename P::state_type>;
+    problem.predecessors(state, out);
+};
+
+/**
+ * @brief Tells whether a problem declares that all action costs and heuristic values are non-negative integers.
+ *
+ * Problems opt in with an `integral_costs()` member; engines use it to pick integer-keyed data structures.
+ */
+template <class P>
+bool declares_integral_costs(const P &problem) {
+    if constexpr (requires { { problem.integral_costs() } -> std::convertible_to<bool>; }) {
+        return problem.integral_costs();
+    } else {
+        return false;
+    }
+}
+
+/**
+ * @brief Base of problem adapters: forwards every SearchProblem member, and the optional ones the problem has, to a wrapped problem.
+ *
+ * Adapters derive from it and redefine only what they change, usually h(). h_batch is not forwarded, since an adapter that
+ * replaces h() would otherwise be bypassed by it. The problem is held by pointer so that adapters such as ProblemSlot can re-point it.
+ */
+template <SearchProblem P>
+class ProblemAdapter {
+public:
+    using state_type = typename P::state_type;
+
+    /// @param problem The wrapped problem; must outlive the adapter.
+    explicit ProblemAdapter(const P &problem) : target(&problem) {}
+
+    /// The wrapped problem.
+    const P &problem() const { return *target; }
+
+    state_type initial() const { return target->initial(); }
+
+    bool is_goal(const state_type &state) const { return target->is_goal(state); }
+
+    double h(const state_type &state) const { return target->h(state); }
+
+    std::size_t hash(const state_type &state) const { return target->hash(state); }
+
+    bool equal(const state_type &a, const state_type &b) const { return target->equal(a, b); }
+
+    void expand(const state_type &state, SuccessorBuffer<state_type> &out) const { target->expand(state, out); }
+
+    bool integral_costs() const { return declares_integral_costs(*target); }
+
+    const std::string &action_name(ActionId action) const requires requires(const P &p, ActionId a) { p.action_name(a); } {
+        return target->action_name(action);
+    }
+
+    bool pack(const state_type &state, std::uint64_t &key) const requires PackableProblem<P> { return target->pack(state, key); }
+
+    state_type goal() const requires BidirectionalProblem<P> { return target->goal(); }
+
+    void predecessors(const state_type &state, SuccessorBuffer<state_type> &out) const requires BidirectionalProblem<P> {
+        target->predecessors(state, out);
+    }
+
+    double h_reverse(const state_type &state) const requires requires(const P &p, const state_type &s) { p.h_reverse(s); } {
+        return target->h_reverse(state);
+    }
+
+protected:
+    /// For adapters that pick their problem later; every call before that is undefined.
+    ProblemAdapter() = default;
+
+    const P *target = nullptr;
+};
+
+/**
+ * @brief Problems that memoize their heuristic and count cache hits and misses, like CachedHeuristic.
+ */
+template <class P>
+concept HeuristicCachingProblem = requires(const P &problem) {
+    { problem.heuristic_cache_hits() } -> std::convertible_to<std::uint64_t>;
+    { problem.heuristic_cache_misses() } -> std::convertible_to<std::uint64_t>;
+};
+
+/**
+ * @brief Node record stored in an engine's arena.
+ */
+template <class S>
+struct EngineNode {
+    S state;
+    double path_cost;
+    double heuristic;
+    NodeId parent;
+    ActionId action; // Action that led here from the parent, unused for the root
+};
+
+/**
+ * @brief Hash functor that keys standard containers on the problem's notion of state identity.
+ */
+template <class P>
+struct ProblemHash {
+    const P *problem;
+    std::size_t operator()(const typename P::state_type &state) const { return problem->hash(state); }
+};
+
+/**
+ * @brief Equality functor matching ProblemHash.
+ */
+template <class P>
+struct ProblemEqual {
+    const P *problem;
+    bool operator()(const typename P::state_type &a, const typename P::state_type &b) const { return problem->equal(a, b); }
+};
+
+
+/**
+ * @brief State and bookkeeping common to all templated engines.
+ *
+ * Owns the node arena and the reusable successor buffer. The arena is reset at the start of every search, keeping its chunks for the new nodes,
+ * and released with the engine, so the nodes of the last search stay readable until the next one starts.
+ * Engines bracket every search with begin_search() and finish(), and go through expand() and heuristic() so that stats() counts
+ * and times the work. Sequential engines also ask out_of_budget() before every expansion and return early when it says so,
+ * which is how limits, cancellation and progress reports reach them; parallel engines share a SharedBudget between their threads instead.
+ */
+template <SearchProblem P>
+class EngineBase {
+public:
+    using state_type = typename P::state_type;
+    using node_type = EngineNode<state_type>;
+
+    explicit EngineBase(const P &problem) : problem(problem) {}
+
+    /// Nodes generated by the last search.
+    const NodeArena<node_type> &nodes() const { return arena; }
+
+    /**
+     * @brief Returns the nodes on the path from the root to the given node.
+     */
+    std::vector<const node_type *> path(NodeId goal) const {
+        std::vector<const node_type *> result;
+        for (NodeId id : arena.path_to(goal)) {
+            result.push_back(&arena[id]);
+        }
+        return result;
+    }
+
+    /// Statistics of the last search.
+    const SearchStats &stats() const { return statistics; }
+
+    /// Time expansions, heuristic calls and frontier operations in stats(); off by default as it reads the clock on the hot path.
+    bool phase_timers = false;
+
+    /// Budgets, cancellation and progress reporting for the following searches.
+    SearchLimits limits;
+
+protected:
+    const P &problem;
+    NodeArena<node_type> arena;
+    SuccessorBuffer<state_type> successors;
+    std::vector<double> estimates;  // Heuristics of the current successors, filled by heuristics()
+    SearchStats statistics;
+
+    /// Resets the statistics and the budget, and starts the search clock.
+    void begin_search() {
+        statistics = SearchStats{};
+        budget_expansions = 0;
+        next_progress = limits.progress_seconds;
+        stop_reason.reset();
+        if constexpr (HeuristicCachingProblem<P>) {
+            cache_hits_before = problem.heuristic_cache_hits();
+            cache_misses_before = problem.heuristic_cache_misses();
+        }
+        started = std::chrono::steady_clock::now();
+    }
+
+    /// Seconds since begin_search(), for engines that enforce a time limit.
+    double elapsed_seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(); }
+
+    /**
+     * @brief Records the outcome of a search and stops its clock.
+     *
+     * Peaks not already recorded by the engine default to the size of the arena and of the peak frontier.
+     *
+     * @return The goal node, so engines can `return this->finish(goal);`.
+     */
+    NodeId finish(NodeId goal, std::size_t frontier_entry_bytes = 0) {
+        statistics.search_seconds = elapsed_seconds();
+        if (statistics.peak_nodes == 0) {
+            statistics.peak_nodes = arena.size();
+            statistics.peak_memory = arena.memory_usage() + statistics.peak_frontier * frontier_entry_bytes;
+        }
+        if constexpr (HeuristicCachingProblem<P>) {
+            // The cache outlives searches, so report only what this one added
+            statistics.heuristic_cache_hits = problem.heuristic_cache_hits() - cache_hits_before;
+            statistics.heuristic_cache_misses = problem.heuristic_cache_misses() - cache_misses_before;
+        }
+        statistics.solved = goal != NO_NODE;
+        statistics.status = stop_reason ? *stop_reason : statistics.solved ? SearchStatus::SOLVED : SearchStatus::NO_SOLUTION;
+        if (statistics.solved) {
+            statistics.solution_cost = arena[goal].path_cost;
+            statistics.solution_depth = arena.path_to(goal).size() - 1;
+        }
+        return goal;
+    }
+
+    /**
+     * @brief Checks the limits before an expansion, and reports progress when it is due.
+     *
+     * Once it returns true the engine should return (usually `this->finish(NO_NODE)`); finish() then records why it stopped.
+     *
+     * @param best_f The f of the node about to be expanded, for the progress report.
+     * @param held Bytes the engine holds outside the arena, its live frontier included, counted against the memory limit.
+     *             Engines pass what they hold now rather than the peaks in stats(), which are not tracked without SYMPHONY_STATS.
+     */
+    bool out_of_budget(double best_f, std::size_t held) {
+        if (limits.cancel.cancelled()) {
+            stop_reason = SearchStatus::CANCELLED;
+            return true;
+        }
+        if (limits.expansions && budget_expansions >= limits.expansions) {
+            stop_reason = SearchStatus::NODE_LIMIT;
+            return true;
+        }
+        if (budget_expansions++ % SearchLimits::CHECK_INTERVAL != 0 || !limits.timed()) {
+            return false;
+        }
+        double seconds = elapsed_seconds();
+        if (limits.seconds > 0 && seconds >= limits.seconds) {
+            stop_reason = SearchStatus::TIME_LIMIT;
+            return true;
+        }
+        std::size_t memory = arena.memory_usage() + held;
+        if (limits.memory && memory >= limits.memory) {
+            stop_reason = SearchStatus::MEMORY_LIMIT;
+            return true;
+        }
+        if (limits.progress && seconds >= next_progress) {
+            next_progress = seconds + limits.progress_seconds;
+            limits.progress(SearchProgress{budget_expansions, best_f, memory, seconds});
+        }
+        return false;
+    }
+
+    /// Why out_of_budget() stopped the current search, if it did.
+    std::optional<SearchStatus> stop_reason;
+
+    /// Starts a new search from the initial state. The stored heuristic is scaled by weight, and not evaluated at all for weight 0.
+    NodeId add_root(double weight = 1.0) {
+        arena.reset();
+        state_type state = problem.initial();
+        double heuristic = weight == 0 ? 0.0 : weight * this->heuristic(state, statistics);
+        return arena.emplace(std::move(state), 0.0, heuristic, NO_NODE, ActionId{0});
+    }
+
+    NodeId add_child(NodeId parent, Successor<state_type> &successor, double path_cost, double heuristic) {
+        return arena.emplace(std::move(successor.state), path_cost, heuristic, parent, successor.action);
+    }
+
+    /// Expands a node into the reusable successor buffer.
+    void expand(NodeId node) {
+        successors.clear();
+        expand(arena[node].state, successors, statistics);
+    }
+
+    /// Appends the successors of a state to a buffer, counting and timing the expansion in the given statistics (a worker's own, when threaded).
+    void expand(const state_type &state, SuccessorBuffer<state_type> &out, SearchStats &stats) const {
+        PhaseTimer timer(stats.expand_seconds, phase_timers);
+        std::size_t before = out.size();
+        problem.expand(state, out);
+        stats.count_expansion(out.size() - before);
+    }
+
+    /// Evaluates the heuristic, counting and timing the call in the given statistics.
+    double heuristic(const state_type &state, SearchStats &stats) const {
+        PhaseTimer timer(stats.heuristic_seconds, phase_timers);
+        stats.count_heuristic();
+        return problem.h(state);
+    }
+
+    /// Evaluates the heuristic for the engine's own statistics.
+    double heuristic(const state_type &state) { return heuristic(state, statistics); }
+
+    /**
+     * @brief Evaluates the heuristic of a run of successors, in a single h_batch call when the problem has one.
+     *
+     * @param batch The successors, usually a prefix of a successor buffer.
+     * @param out Resized to the batch and filled with one estimate per successor.
+     * @param stats Statistics counting one heuristic call per successor.
+     */
+    void heuristics(std::span<const Successor<state_type>> batch, std::vector<double> &out, SearchStats &stats) const {
+        out.resize(batch.size());
+        if (batch.empty()) {
+            return;
+        }
+        PhaseTimer timer(stats.heuristic_seconds, phase_timers);
+        stats.count_heuristic(batch.size());
+        if constexpr (BatchHeuristicProblem<P>) {
+            problem.h_batch(batch, std::span<double>(out));
+        } else {
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                out[i] = problem.h(batch[i].state);
+            }
+        }
+    }
+
+private:
+    std::chrono::steady_clock::time_point started;
+    std::uint64_t cache_hits_before = 0;
+    std::uint64_t cache_misses_before = 0;
+    std::uint64_t budget_expansions = 0;
+    double next_progress = 0.0;
+};
+
+/**
+ * @brief The limits of a parallel search, checked by all of its threads.
+ *
+ * Threads call check() with the totals they know of, or spend() before each of their own expansions, which pools expansions
+ * and memory across threads and reads the clock every SearchLimits::CHECK_INTERVAL expansions of the thread.
+ * The first limit reached stops every thread: from then on both return true, and reason() tells the engine why for finish().
+ */
+class SharedBudget {
+public:
+    /// One thread's share of the budget.
+    struct Account {
+        std::uint64_t expansions = 0;
+        std::size_t memory = 0;  ///< Bytes last reported by the thread
+        bool reports = false;    ///< Calls limits.progress; set on one thread only
+    };
+
+    /// Starts the clock; construct it when the search starts.
+    explicit SharedBudget(const SearchLimits &limits)
+        : limits(limits), started(std::chrono::steady_clock::now()), next_progress(limits.progress_seconds) {}
+
+    bool stopped() const { return stop_code.load(std::memory_order_relaxed) >= 0; }
+
+    /// The limit that stopped the search, if one did.
+    std::optional<SearchStatus> reason() const {
+        int code = stop_code.load();
+        return code >= 0 ? std::optional<SearchStatus>(static_cast<SearchStatus>(code)) : std::nullopt;
+    }
+
+    /**
+     * @brief Checks every limit against totals the caller has gathered, and reports progress when reports is set.
+     *
+     * @param expanded Expansions of all threads so far.
+     * @param best_f The current f bound, for the progress report.
+     * @param memory Estimated bytes held by all threads.
+     */
+    bool check(std::uint64_t expanded, double best_f, std::size_t memory, bool reports) {
+        if (stopped()) {
+            return true;
+        }
+        if (limits.cancel.cancelled()) {
+            return stop(SearchStatus::CANCELLED);
+        }
+        if (limits.expansions && expanded >= limits.expansions) {
+            return stop(SearchStatus::NODE_LIMIT);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (limits.seconds > 0 && seconds >= limits.seconds) {
+            return stop(SearchStatus::TIME_LIMIT);
+        }
+        if (limits.memory && memory >= limits.memory) {
+            return stop(SearchStatus::MEMORY_LIMIT);
+        }
+        if (reports && limits.progress && seconds >= next_progress) {
+            next_progress = seconds + limits.progress_seconds;
+            limits.progress(SearchProgress{expanded, best_f, memory, seconds});
+        }
+        return false;
+    }
+
+    /**
+     * @brief Counts one expansion of a thread, before it happens, and tells whether the thread must stop instead.
+     *
+     * @param account The thread's account.
+     * @param best_f The f of the node about to be expanded.
+     * @param memory Returns the bytes the thread holds; only called on the clock's cadence.
+     */
+    template <class Memory>
+    bool spend(Account &account, double best_f, Memory memory) {
+        if (stopped()) {
+            return true;
+        }
+        if (limits.cancel.cancelled()) {
+            return stop(SearchStatus::CANCELLED);
+        }
+        // The shared counter is only touched when there is a limit or a report that needs it
+        bool counted = limits.expansions || limits.timed();
+        std::uint64_t before = counted ? expanded.fetch_add(1, std::memory_order_relaxed) : 0;
+        if (limits.expansions && before >= limits.expansions) {
+            return stop(SearchStatus::NODE_LIMIT);
+        }
+        if (account.expansions++ % SearchLimits::CHECK_INTERVAL != 0 || !limits.timed()) {
+            return false;
+        }
+        std::size_t bytes = memory();
+        std::size_t total = held.fetch_add(bytes - account.memory, std::memory_order_relaxed) + (bytes - account.memory);
+        account.memory = bytes;
+        return check(before, best_f, total, account.reports);
+    }
+
+private:
+    const SearchLimits &limits;
+    std::chrono::steady_clock::time_point started;
+    double next_progress;  // Only read and written by the reporting thread
+    std::atomic<int> stop_code{-1};
+    std::atomic<std::uint64_t> expanded{0};
+    std::atomic<std::size_t> held{0};  // Sums of the accounts' memory; wraps harmlessly while a thread's share shrinks
+
+    bool stop(SearchStatus reason) {
+        int none = -1;
+        stop_code.compare_exchange_strong(none, static_cast<int>(reason));
+        return true;
+    }
+};
+
+/**
+ * @brief Runs engine.search() on a new thread and returns its result as a future.
+ *
+ * Set the engine's limits first; cancel through the token kept from them. The engine, and the problem it searches,
+ * must outlive the future and must not be used by the caller until the future is ready.
+ */
+template <class Engine>
+auto search_async(Engine &engine) -> std::future<decltype(engine.search())> {
+    return std::async(std::launch::async, [&engine] { return engine.search(); });
+}
+
+#endif // ENGINE_H
@@ -0,0 +1,246 @@
+/**
+ * @file frontier.h
+ * @brief Interchangeable priority queues for best-first engines.
+ *
+ * Every frontier offers the same operations, so an engine can be instantiated with any of them:
+ * - `push(node, slot, f, h)` queues a node. `slot` is a dense id of the node's state, which lets a frontier
+ *   replace an entry for the same state instead of queueing a duplicate,
+ * - `pop()` removes and returns a node with the lowest f, preferring lower h on ties,
+ * - `top_f()` returns that lowest f without removing anything (the frontier must not be empty),
+ * - `empty()`, `size()` and `clear()`.
+ */
+
+#ifndef ENGINE_FRONTIER_H
+#define ENGINE_FRONTIER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../node_arena.h"
+
+/**
+ * @brief Selects the frontier a best-first engine uses.
+ */
+enum class FrontierKind {
+    AUTO,          ///< BUCKET when the problem declares integral costs, INDEXED_HEAP otherwise
+    BINARY_HEAP,   ///< Binary heap with lazy deletion of stale entries
+    INDEXED_HEAP,  ///< 4-ary heap with decrease-key, at most one entry per state
+    BUCKET         ///< Dial's bucket queue for non-negative integer f-values, O(1) to find the lowest f
+};
+
+/**
+ * @brief Entry in a best-first frontier, referring to a node in the engine's arena.
+ */
+struct FrontierEntry {
+    double f;
+    double h;
+    NodeId node;
+    std::uint32_t slot;
+};
+
+/**
+ * @brief Orders frontier entries so the lowest f, then the lowest h, comes out of a standard heap (std::push_heap, std::priority_queue) first.
+ */
+struct NodeComparator {
+    bool operator()(const FrontierEntry &a, const FrontierEntry &b) const {
+        return a.f > b.f || (a.f == b.f && a.h > b.h);
+    }
+};
+
+/**
+ * @brief Binary heap frontier. Stale entries stay queued and are skipped by the engine when popped.
+ */
+class BinaryHeapFrontier {
+public:
+    void push(NodeId node, std::uint32_t slot, double f, double h) {
+        heap.push_back({f, h, node, slot});
+        std::push_heap(heap.begin(), heap.end(), NodeComparator{});
+    }
+
+    NodeId pop() {
+        std::pop_heap(heap.begin(), heap.end(), NodeComparator{});
+        NodeId node = heap.back().node;
+        heap.pop_back();
+        return node;
+    }
+
+    double top_f() const { return heap.front().f; }
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+    /// Empties the heap, keeping its capacity.
+    void clear() { heap.clear(); }
+
+private:
+    std::vector<FrontierEntry> heap;  // Max-heap under NodeComparator, so the front has the lowest f
+};
+
+/**
+ * @brief 4-ary heap indexed by state slot.
+ *
+ * Pushing a state that is already queued updates its entry in place (decrease-key), so the heap never holds more entries than open states.
+ * A 4-ary layout halves the height of a binary heap and keeps the children of a node in one cache line.
+ */
+class IndexedHeapFrontier {
+public:
+    void push(NodeId node, std::uint32_t slot, double f, double h) {
+        if (slot >= position.size()) {
+            position.resize(static_cast<std::size_t>(slot) + 1, ABSENT);
+        }
+        FrontierEntry entry{f, h, node, slot};
+        std::size_t i = position[slot];
+        if (i == ABSENT) {
+            heap.push_back(entry);
+            sift_up(heap.size() - 1);
+        } else {
+            heap[i] = entry;
+            sift_up(i);
+            sift_down(position[slot]);
+        }
+    }
+
+    /// The node pop() would return, without removing it.
+    NodeId top() const { return heap.front().node; }
+
+    double top_f() const { return heap.front().f; }
+
+    NodeId pop() {
+        FrontierEntry top = heap.front();
+        position[top.slot] = ABSENT;
+        heap.front() = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            position[heap.front().slot] = 0;
+            sift_down(0);
+        }
+        return top.node;
+    }
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+
+    void clear() {
+        heap.clear();
+        position.clear();
+    }
+
+private:
+    static constexpr std::size_t ARITY = 4;
+    static constexpr std::uint32_t ABSENT = ~std::uint32_t(0);
+    std::vector<FrontierEntry> heap;
+    std::vector<std::uint32_t> position; // Heap index of each slot, or ABSENT
+
+    static bool before(const FrontierEntry &a, const FrontierEntry &b) {
+        return a.f < b.f || (a.f == b.f && a.h < b.h);
+    }
+
+    void place(std::size_t i, const FrontierEntry &entry) {
+        heap[i] = entry;
+        position[entry.slot] = static_cast<std::uint32_t>(i);
+    }
+
+    void sift_up(std::size_t i) {
+        FrontierEntry entry = heap[i];
+        while (i > 0) {
+            std::size_t parent = (i - 1) / ARITY;
+            if (!before(entry, heap[parent])) {
+                break;
+            }
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, entry);
+    }
+
+    void sift_down(std::size_t i) {
+        FrontierEntry entry = heap[i];
+        while (true) {
+            std::size_t first = i * ARITY + 1;
+            if (first >= heap.size()) {
+                break;
+            }
+            std::size_t best = first;
+            std::size_t last = std::min(first + ARITY, heap.size());
+            for (std::size_t child = first + 1; child < last; child++) {
+                if (before(heap[child], heap[best])) {
+                    best = child;
+                }
+            }
+            if (!before(heap[best], entry)) {
+                break;
+            }
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, entry);
+    }
+};
+
+/**
+ * @brief Dial's bucket queue for non-negative integer f-values.
+ *
+ * One bucket per f-value. Each bucket is a small binary heap on h, so ties on f go to lower h as in the other frontiers;
+ * push and pop cost O(1) amortised to find the bucket plus O(log k) within a bucket of k entries.
+ * The buckets span the range of f-values seen, which stays small on unit-cost domains.
+ * Stale entries are skipped by the engine when popped.
+ */
+class BucketFrontier {
+public:
+    void push(NodeId node, std::uint32_t, double f, double h) {
+        auto index = static_cast<std::size_t>(f);
+        if (index >= buckets.size()) {
+            buckets.resize(index + 1);
+        }
+        std::vector<Entry> &bucket = buckets[index];
+        bucket.push_back(Entry{h, node});
+        std::push_heap(bucket.begin(), bucket.end(), higher_h);
+        if (index < current) {
+            current = index;
+        }
+        count++;
+    }
+
+    NodeId pop() {
+        std::vector<Entry> &bucket = buckets[lowest_bucket()];
+        std::pop_heap(bucket.begin(), bucket.end(), higher_h);
+        NodeId node = bucket.back().node;
+        bucket.pop_back();
+        count--;
+        return node;
+    }
+
+    double top_f() const { return static_cast<double>(lowest_bucket()); }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void clear() {
+        for (auto &bucket : buckets) {
+            bucket.clear();
+        }
+        current = 0;
+        count = 0;
+    }
+
+private:
+    struct Entry {
+        double h;
+        NodeId node;
+    };
+
+    static bool higher_h(const Entry &a, const Entry &b) { return a.h > b.h; }
+
+    std::vector<std::vector<Entry>> buckets;
+    mutable std::size_t current = 0; // Lowest bucket that may be non-empty
+    std::size_t count = 0;
+
+    std::size_t lowest_bucket() const {
+        while (buckets[current].empty()) {
+            current++;
+        }
+        return current;
+    }
+};
+
+#endif // ENGINE_FRONTIER_H
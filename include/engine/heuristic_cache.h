@@ -0,0 +1,179 @@
+/**
+ * @file heuristic_cache.h
+ * @brief Problem adapter that memoizes an expensive heuristic in a bounded cache.
+ */
+
+#ifndef ENGINE_HEURISTIC_CACHE_H
+#define ENGINE_HEURISTIC_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+
+/**
+ * @brief Which entry a full heuristic cache gives up for a new one.
+ */
+enum class CacheEviction {
+    LRU,   ///< The least recently used entry; every hit moves its entry to the front of a list
+    CLOCK, ///< Second chance: a hit only sets a reference bit, and a hand sweeping the entries evicts the first one without it
+};
+
+/**
+ * @brief Wraps a problem so that its heuristic is evaluated at most once per cached state.
+ *
+ * Every other member is forwarded to the wrapped problem (see ProblemAdapter), so the adapter runs on any engine the problem runs on.
+ * Entries are found by the problem's state hash and confirmed with equal(), so a hash collision costs a miss and never a wrong value.
+ * At most capacity entries are kept; when full, the eviction policy picks the one to replace.
+ *
+ * Worth it for heuristics that cost more than a hash, a lookup and an uncontended lock, and for engines that evaluate the same state
+ * many times, like IDA* across iterations or SMA* after forgetting nodes. Safe to share between threads: lookups take a lock, but the
+ * heuristic itself is evaluated outside it. Engines report the hits and misses of each search in SearchStats.
+ */
+template <SearchProblem P>
+class CachedHeuristic : public ProblemAdapter<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem whose heuristic is cached; must outlive the adapter.
+     * @param capacity Most entries kept at once, at least 1.
+     * @param eviction How a full cache makes room.
+     */
+    CachedHeuristic(const P &problem, std::size_t capacity, CacheEviction eviction = CacheEviction::CLOCK)
+        : ProblemAdapter<P>(problem), capacity(std::max<std::size_t>(capacity, 1)), eviction(eviction) {}
+
+    /// The wrapped problem's heuristic, from the cache when the state is in it.
+    double h(const state_type &state) const {
+        std::size_t key = this->problem().hash(state);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            if (found != index.end() && this->problem().equal(entries[found->second].state, state)) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                touch(found->second);
+                return entries[found->second].h;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        double value = this->problem().h(state);
+        std::lock_guard<std::mutex> lock(mutex);
+        store(key, state, value);
+        return value;
+    }
+
+    /// Lookups answered from the cache since it was created.
+    std::uint64_t heuristic_cache_hits() const { return hits.load(std::memory_order_relaxed); }
+
+    /// Lookups that had to evaluate the heuristic since the cache was created.
+    std::uint64_t heuristic_cache_misses() const { return misses.load(std::memory_order_relaxed); }
+
+    /// Entries currently cached.
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    /// Drops every entry; the hit and miss counters keep running.
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        head = tail = NONE;
+        hand = 0;
+    }
+
+    const std::size_t capacity;
+    const CacheEviction eviction;
+
+private:
+    static constexpr std::uint32_t NONE = ~std::uint32_t(0);
+
+    struct Entry {
+        state_type state;
+        double h;
+        std::size_t key;
+        std::uint32_t newer;  // LRU list neighbours, towards head and tail
+        std::uint32_t older;
+        bool referenced;      // CLOCK reference bit
+    };
+
+    mutable std::mutex mutex;
+    mutable std::vector<Entry> entries;
+    mutable std::unordered_map<std::size_t, std::uint32_t> index;
+    mutable std::uint32_t head = NONE;  // Most recently used
+    mutable std::uint32_t tail = NONE;  // Least recently used
+    mutable std::size_t hand = 0;
+    mutable std::atomic<std::uint64_t> hits{0};
+    mutable std::atomic<std::uint64_t> misses{0};
+
+    void unlink(std::uint32_t slot) const {
+        Entry &entry = entries[slot];
+        (entry.newer == NONE ? head : entries[entry.newer].older) = entry.older;
+        (entry.older == NONE ? tail : entries[entry.older].newer) = entry.newer;
+    }
+
+    void push_front(std::uint32_t slot) const {
+        entries[slot].newer = NONE;
+        entries[slot].older = head;
+        (head == NONE ? tail : entries[head].newer) = slot;
+        head = slot;
+    }
+
+    void touch(std::uint32_t slot) const {
+        if (eviction == CacheEviction::CLOCK) {
+            entries[slot].referenced = true;
+        } else if (slot != head) {
+            unlink(slot);
+            push_front(slot);
+        }
+    }
+
+    std::uint32_t victim() const {
+        if (eviction == CacheEviction::LRU) {
+            return tail;
+        }
+        while (entries[hand].referenced) {
+            entries[hand].referenced = false;
+            hand = (hand + 1) % entries.size();
+        }
+        auto slot = static_cast<std::uint32_t>(hand);
+        hand = (hand + 1) % entries.size();
+        return slot;
+    }
+
+    void store(std::size_t key, const state_type &state, double value) const {
+        std::uint32_t slot;
+        auto found = index.find(key);
+        if (found != index.end()) {
+            // Another thread stored this state meanwhile, or a different state shares the hash: the newer one wins
+            slot = found->second;
+        } else if (entries.size() < capacity) {
+            slot = static_cast<std::uint32_t>(entries.size());
+            entries.push_back(Entry{state, value, key, NONE, NONE, false});
+            index.emplace(key, slot);
+            if (eviction == CacheEviction::LRU) {
+                push_front(slot);
+            }
+            return;
+        } else {
+            slot = victim();
+            index.erase(entries[slot].key);
+            index.emplace(key, slot);
+        }
+        Entry &entry = entries[slot];
+        entry.state = state;
+        entry.h = value;
+        entry.key = key;
+        entry.referenced = false;
+        if (eviction == CacheEviction::LRU && slot != head) {
+            unlink(slot);
+            push_front(slot);
+        }
+    }
+};
+
+#endif // ENGINE_HEURISTIC_CACHE_H
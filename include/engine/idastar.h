@@ -0,0 +1,202 @@
+/**
+ * @file idastar.h
+ * @brief Compile-time specialized iterative-deepening A*.
+ */
+
+#ifndef ENGINE_IDASTAR_H
+#define ENGINE_IDASTAR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+#include "engine.h"
+#include "../visited_set.h"
+
+/**
+ * @brief Iterative-deepening A* over a problem known at compile time.
+ *
+ * Runs depth-first searches bounded by f = g + h. Each iteration raises the bound to the smallest f that exceeded the previous one,
+ * so the first goal reached is optimal for an admissible heuristic.
+ * The only per-search memory is the current path: one frame and one reusable successor buffer per depth, so usage grows with
+ * solution depth rather than with the number of generated nodes. Children whose state is already on the current path are skipped,
+ * which keeps every iteration finite and lets the search report that no solution exists.
+ *
+ * An optional direct-mapped transposition table of a fixed number of entries prunes states already expanded during the current iteration
+ * at no greater cost, which cuts the re-expansions IDA* suffers on graphs with many paths to a state.
+ * On success only the solution path is written to nodes().
+ */
+template <SearchProblem P>
+class IDAStar : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem to solve.
+     * @param transposition_entries Size of the transposition table, rounded up to a power of two; 0 disables it.
+     */
+    explicit IDAStar(const P &problem, std::size_t transposition_entries = 0) : EngineBase<P>(problem) {
+        if (transposition_entries) {
+            std::size_t size = 1;
+            while (size < transposition_entries) {
+                size <<= 1;
+            }
+            table.resize(size);
+        }
+    }
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        this->begin_search();
+        this->arena.clear();
+        iteration_count = 0;
+        expanded = 0;
+        deepest = 0;
+        state_type root = this->problem.initial();
+        double root_h = this->heuristic(root);
+        double bound = root_h;
+
+        while (bound != std::numeric_limits<double>::infinity()) {
+            iteration_count++;
+            stamp++;
+            double next_bound = std::numeric_limits<double>::infinity();
+            stack.clear();
+            stack.push_back(Frame{root, 0.0, root_h, ActionId{0}});
+            bool entering = true;
+
+            while (!stack.empty()) {
+                std::size_t depth = stack.size() - 1;
+                if (entering) {
+                    entering = false;
+                    Frame &top = stack.back();
+                    double f = top.g + top.h;
+                    if (f > bound) {
+                        next_bound = std::min(next_bound, f);
+                        stack.pop_back();
+                        continue;
+                    }
+                    if (this->problem.is_goal(top.state)) {
+                        return finish(emit_path());
+                    }
+                    if (!table.empty() && transposed(top.state, top.g)) {
+                        this->statistics.count_duplicate();
+                        stack.pop_back();
+                        continue;
+                    }
+                    if (this->out_of_budget(bound, table.size() * sizeof(Entry) + stack.size() * sizeof(Frame))) {
+                        return finish(NO_NODE);
+                    }
+                    if (depth >= buffers.size()) {
+                        buffers.resize(depth + 1);
+                        child_h.resize(depth + 1);
+                        cursors.resize(depth + 1);
+                    }
+                    buffers[depth].clear();
+                    this->expand(top.state, buffers[depth], this->statistics);
+                    this->heuristics(buffers[depth].all(), child_h[depth], this->statistics);
+                    this->statistics.track_frontier(stack.size());
+                    deepest = std::max(deepest, stack.size());
+                    cursors[depth] = 0;
+                    expanded++;
+                }
+
+                SuccessorBuffer<state_type> &children = buffers[depth];
+                while (cursors[depth] < children.size()) {
+                    std::size_t index = cursors[depth]++;
+                    Successor<state_type> &child = children[index];
+                    if (on_path(child.state)) {
+                        continue;
+                    }
+                    double g = stack[depth].g + child.cost;
+                    double h = child_h[depth][index];
+                    stack.push_back(Frame{std::move(child.state), g, h, child.action});
+                    entering = true;
+                    break;
+                }
+                if (!entering) {
+                    stack.pop_back();
+                }
+            }
+            bound = next_bound;
+        }
+        return finish(NO_NODE);
+    }
+
+    /// Depth-first iterations run by the last search.
+    std::size_t iterations() const { return iteration_count; }
+
+    /// Nodes expanded by the last search, over all iterations.
+    std::size_t expansions() const { return expanded; }
+
+private:
+    struct Frame {
+        state_type state;
+        double g;
+        double h;
+        ActionId action;  // Action from the previous frame
+    };
+
+    struct Entry {
+        std::optional<state_type> state;
+        double g = 0.0;
+        std::uint32_t stamp = 0;  // Iteration that wrote the entry; older entries are ignored
+    };
+
+    std::vector<Frame> stack;
+    std::size_t deepest = 0;  // Deepest stack of the current search, kept whether or not stats are compiled in
+    std::vector<SuccessorBuffer<state_type>> buffers;  // Successors of the frame at each depth
+    std::vector<std::vector<double>> child_h;          // Their heuristics, evaluated as one batch per expansion
+    std::vector<std::size_t> cursors;                  // Next successor to try at each depth
+    std::vector<Entry> table;
+    std::uint32_t stamp = 0;
+    std::size_t iteration_count = 0;
+    std::size_t expanded = 0;
+
+    bool on_path(const state_type &state) const {
+        for (const Frame &frame : stack) {
+            if (this->problem.equal(frame.state, state)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// True if the state was already expanded this iteration at no greater cost; otherwise records this visit.
+    bool transposed(const state_type &state, double g) {
+        Entry &entry = table[mix_bits(this->problem.hash(state)) & (table.size() - 1)];
+        if (entry.stamp == stamp && entry.g <= g && this->problem.equal(*entry.state, state)) {
+            return true;
+        }
+        entry.state = state;
+        entry.g = g;
+        entry.stamp = stamp;
+        return false;
+    }
+
+    /// The path is the only memory IDA* holds: its peak is the deepest stack with one successor buffer per frame.
+    NodeId finish(NodeId goal) {
+        this->statistics.peak_nodes = deepest;
+        std::size_t buffered = 0;
+        for (auto &buffer : buffers) {
+            buffered += buffer.size();
+        }
+        this->statistics.peak_memory = deepest * sizeof(Frame) + buffered * sizeof(Successor<state_type>);
+        return EngineBase<P>::finish(goal);
+    }
+
+    NodeId emit_path() {
+        NodeId parent = NO_NODE;
+        for (auto &frame : stack) {
+            parent = this->arena.emplace(std::move(frame.state), frame.g, frame.h, parent, frame.action);
+        }
+        stack.clear();
+        return parent;
+    }
+};
+
+#endif // ENGINE_IDASTAR_H
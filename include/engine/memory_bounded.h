@@ -0,0 +1,381 @@
+/**
+ * @file memory_bounded.h
+ * @brief Compile-time specialized memory-bounded A* (SMA*).
+ */
+
+#ifndef ENGINE_MEMORY_BOUNDED_H
+#define ENGINE_MEMORY_BOUNDED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <set>
+#include <vector>
+#include "engine.h"
+
+/**
+ * @brief Simplified memory-bounded A* (SMA*) over a problem known at compile time.
+ *
+ * Searches a tree of nodes like A*, but never holds more nodes than fit in a byte budget. Each node costs node_bytes():
+ * its record in the node store plus its entries in the open list and in the set of leaves.
+ * When the budget is full, each new child displaces the leaf with the highest f (shallowest first on ties), or is itself forgotten
+ * straight away if it is no better than that leaf.
+ * A dropped leaf's f is remembered in its parent, which reopens with that value and regenerates the forgotten children when it
+ * becomes the best candidate again. Interior f-values are backed up from their children, so they stay tight lower bounds.
+ *
+ * Paths longer than the budget can hold are cut off (their f becomes infinite). The search is complete and optimal whenever the
+ * optimal path fits; otherwise best_effort() reports that the solution returned, if any, could not be proven optimal.
+ * States already on a node's path are not generated again; other duplicates are kept, as in tree search.
+ *
+ * When the budget is far below what the search needs, SMA* can spend a very long time regenerating the same subtrees among nodes of
+ * equal f. An optional expansion limit stops it there; hitting the limit also counts as best effort.
+ */
+template <SearchProblem P>
+class MemoryBoundedAStar : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem to solve.
+     * @param memory_budget Bytes the search may hold; at least two nodes' worth is always allowed.
+     * @param expansion_limit Expansions after which the search gives up; 0 means no limit.
+     */
+    MemoryBoundedAStar(const P &problem, std::size_t memory_budget, std::size_t expansion_limit = 0)
+        : EngineBase<P>(problem), memory_budget(memory_budget), expansion_limit(expansion_limit) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), which then holds only the solution path, or NO_NODE if no solution fits in the budget
+     *         or the expansion limit was reached first.
+     */
+    NodeId search() {
+        this->begin_search();
+        pool.clear();
+        free_list.clear();
+        open.clear();
+        leaves.clear();
+        live = 0;
+        peak = 0;
+        expanded = 0;
+        cutoff = std::numeric_limits<double>::infinity();
+        fell_back = false;
+        max_nodes = std::max<std::size_t>(2, memory_budget / node_bytes());
+
+        state_type state = this->problem.initial();
+        double heuristic = this->heuristic(state);
+        NodeId root = allocate(std::move(state), 0.0, heuristic, heuristic, NO_NODE, ActionId{0}, 0, 0);
+        attach_open(root);
+
+        while (!open.empty() && open.begin()->f != INF) {
+            NodeId id = open.begin()->id;
+            if (this->problem.is_goal(*pool[id].state)) {
+                // Optimal unless a path cut off for lack of memory might have been cheaper
+                fell_back = cutoff < pool[id].g;
+                return finish(emit_path(id));
+            }
+            if ((expansion_limit && expanded == expansion_limit) || this->out_of_budget(open.begin()->f, live * node_bytes())) {
+                fell_back = true;
+                this->arena.clear();
+                return finish(NO_NODE);
+            }
+            expand(id);
+            expanded++;
+            this->statistics.track_frontier(open.size());
+        }
+        fell_back = cutoff != INF;
+        this->arena.clear();
+        return finish(NO_NODE);
+    }
+
+    /// True if the last search cut off paths that might have led to a better (or any) solution.
+    bool best_effort() const { return fell_back; }
+
+    /// Nodes expanded by the last search, counting regenerations.
+    std::size_t expansions() const { return expanded; }
+
+    /// Most nodes held at once by the last search.
+    std::size_t peak_nodes() const { return peak; }
+
+    /// Most bytes held at once by the last search, by the node_bytes() estimate.
+    std::size_t peak_memory() const { return peak * node_bytes(); }
+
+    /// Bytes charged per node: the node record plus one entry in each ordered set (tree node overhead estimated at four pointers).
+    static constexpr std::size_t node_bytes() { return sizeof(Entry) + 2 * (sizeof(Key) + 4 * sizeof(void *)); }
+
+    std::size_t memory_budget;
+    std::size_t expansion_limit;
+
+private:
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+    struct Entry {
+        std::optional<state_type> state;  // Empty while the slot is free
+        double g;
+        double h;
+        double f;          // Backed-up lower bound on solutions through this node
+        double forgotten;  // Lowest f among dropped children, INF if none
+        NodeId parent;
+        NodeId first_child;
+        NodeId next_sibling;
+        NodeId prev_sibling;
+        ActionId action;
+        std::uint32_t depth;
+        std::uint32_t position;  // Index among the parent's successors
+        std::uint64_t dead;      // Successors among the first 64 known to lead nowhere, never regenerated
+        bool expanded;
+        bool in_open;
+        bool in_leaves;
+        double open_key;
+    };
+
+    struct Key {
+        double f;
+        std::uint32_t depth;
+        NodeId id;
+    };
+
+    // Lowest f first, deepest first on ties: the first open key is the best node and the last leaf key the worst (highest f, shallowest)
+    struct KeyOrder {
+        bool operator()(const Key &a, const Key &b) const {
+            return a.f < b.f || (a.f == b.f && (a.depth > b.depth || (a.depth == b.depth && a.id < b.id)));
+        }
+    };
+
+    NodeArena<Entry> pool;
+    std::vector<NodeId> free_list;
+    std::set<Key, KeyOrder> open;
+    std::set<Key, KeyOrder> leaves;
+    std::size_t live = 0;
+    std::size_t peak = 0;
+    std::size_t expanded = 0;
+    std::size_t max_nodes = 0;
+    NodeId expanding = NO_NODE;
+    double cutoff = INF;  // Lowest f of a path cut off at the depth the budget allows
+    bool fell_back = false;
+
+    NodeId allocate(state_type &&state, double g, double h, double f, NodeId parent, ActionId action, std::uint32_t depth,
+                    std::uint32_t position) {
+        Entry entry{std::move(state), g, h, f, INF, parent, NO_NODE, NO_NODE, NO_NODE, action, depth, position, 0, false, false, false, 0.0};
+        NodeId id;
+        if (free_list.empty()) {
+            id = pool.emplace(std::move(entry));
+        } else {
+            id = free_list.back();
+            free_list.pop_back();
+            pool[id] = std::move(entry);
+        }
+        if (parent != NO_NODE) {
+            Entry &up = pool[parent];
+            pool[id].next_sibling = up.first_child;
+            if (up.first_child != NO_NODE) {
+                pool[up.first_child].prev_sibling = id;
+            }
+            up.first_child = id;
+        }
+        peak = std::max(peak, ++live);
+        return id;
+    }
+
+    void release(NodeId id) {
+        Entry &entry = pool[id];
+        Entry &up = pool[entry.parent];
+        if (entry.prev_sibling != NO_NODE) {
+            pool[entry.prev_sibling].next_sibling = entry.next_sibling;
+        } else {
+            up.first_child = entry.next_sibling;
+        }
+        if (entry.next_sibling != NO_NODE) {
+            pool[entry.next_sibling].prev_sibling = entry.prev_sibling;
+        }
+        entry.state.reset();
+        free_list.push_back(id);
+        live--;
+    }
+
+    // A node is open while it is unexpanded, or expanded with forgotten children to regenerate
+    void attach_open(NodeId id) {
+        detach_open(id);
+        Entry &entry = pool[id];
+        double key = entry.expanded ? entry.forgotten : entry.f;
+        if (key == INF) {
+            return;
+        }
+        entry.open_key = key;
+        entry.in_open = true;
+        open.insert(Key{key, entry.depth, id});
+    }
+
+    void detach_open(NodeId id) {
+        Entry &entry = pool[id];
+        if (entry.in_open) {
+            open.erase(Key{entry.open_key, entry.depth, id});
+            entry.in_open = false;
+        }
+    }
+
+    // Leaves are the nodes without children in memory, except the root, which is never dropped
+    void attach_leaf(NodeId id) {
+        Entry &entry = pool[id];
+        if (entry.parent != NO_NODE && !entry.in_leaves) {
+            entry.in_leaves = true;
+            leaves.insert(Key{entry.f, entry.depth, id});
+        }
+    }
+
+    void detach_leaf(NodeId id) {
+        Entry &entry = pool[id];
+        if (entry.in_leaves) {
+            leaves.erase(Key{entry.f, entry.depth, id});
+            entry.in_leaves = false;
+        }
+    }
+
+    bool on_path(NodeId id, const state_type &state) const {
+        for (; id != NO_NODE; id = pool[id].parent) {
+            if (this->problem.equal(*pool[id].state, state)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool has_child(NodeId id, const state_type &state) const {
+        for (NodeId child = pool[id].first_child; child != NO_NODE; child = pool[child].next_sibling) {
+            if (this->problem.equal(*pool[child].state, state)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void expand(NodeId id) {
+        expanding = id;
+        detach_open(id);
+        detach_leaf(id);
+        Entry &node = pool[id];
+        bool regenerating = node.expanded;
+        // Forgotten children were dropped with an f of at least this value
+        double floor = regenerating ? node.forgotten : node.f;
+        node.expanded = true;
+        node.forgotten = INF;
+
+        this->successors.clear();
+        EngineBase<P>::expand(*node.state, this->successors, this->statistics);
+        this->heuristics(this->successors.all(), this->estimates, this->statistics);
+        std::uint32_t position = 0;
+        for (auto &successor : this->successors) {
+            std::uint32_t index = position++;
+            if (is_dead(pool[id], index)) {
+                continue;
+            }
+            if (on_path(id, successor.state) || (regenerating && has_child(id, successor.state))) {
+                this->statistics.count_duplicate();
+                continue;
+            }
+            double g = pool[id].g + successor.cost;
+            double h = this->estimates[index];
+            double f = std::max(floor, g + h);
+            std::uint32_t depth = pool[id].depth + 1;
+            if (depth + 1 >= max_nodes && !this->problem.is_goal(successor.state)) {
+                // Its children could not be held together with their path
+                cutoff = std::min(cutoff, f);
+                f = INF;
+            }
+            if (live >= max_nodes) {
+                // Full: the child only gets in by displacing a worse leaf, otherwise it is forgotten straight away
+                if (leaves.empty() || !KeyOrder{}(Key{f, depth, NO_NODE - 1}, *std::prev(leaves.end()))) {
+                    forget(pool[id], index, f);
+                    continue;
+                }
+                drop_worst_leaf();
+            }
+            NodeId child = allocate(std::move(successor.state), g, h, f, id, successor.action, depth, index);
+            attach_open(child);
+            attach_leaf(child);
+        }
+
+        if (pool[id].first_child == NO_NODE) {
+            attach_leaf(id);
+        }
+        attach_open(id);
+        backup(id);
+        expanding = NO_NODE;
+    }
+
+    /// Raises f-values from a node upwards to the lowest f among their children and forgotten children.
+    void backup(NodeId id) {
+        while (id != NO_NODE) {
+            Entry &node = pool[id];
+            double best = node.forgotten;
+            for (NodeId child = node.first_child; child != NO_NODE; child = pool[child].next_sibling) {
+                best = std::min(best, pool[child].f);
+            }
+            double f = std::max(node.f, best);
+            if (f == node.f) {
+                return;
+            }
+            bool leaf = node.in_leaves;
+            detach_leaf(id);
+            node.f = f;
+            if (leaf) {
+                attach_leaf(id);
+            }
+            id = node.parent;
+        }
+    }
+
+    static bool is_dead(const Entry &entry, std::uint32_t position) {
+        return position < 64 && (entry.dead >> position & 1);
+    }
+
+    /// Records a child that is not kept in memory. Dead ends are remembered individually so that regenerating their siblings skips them.
+    static void forget(Entry &parent, std::uint32_t position, double f) {
+        if (f == INF) {
+            if (position < 64) {
+                parent.dead |= std::uint64_t(1) << position;
+            }
+            return;
+        }
+        parent.forgotten = std::min(parent.forgotten, f);
+    }
+
+    /// Drops the leaf with the highest f, shallowest on ties, and remembers its f in its parent.
+    void drop_worst_leaf() {
+        NodeId id = std::prev(leaves.end())->id;
+        detach_leaf(id);
+        detach_open(id);
+        NodeId parent = pool[id].parent;
+        Entry &up = pool[parent];
+        forget(up, pool[id].position, pool[id].f);
+        release(id);
+        attach_open(parent);
+        // The node being expanded becomes a leaf, if at all, only once its expansion is complete
+        if (up.first_child == NO_NODE && parent != expanding) {
+            attach_leaf(parent);
+        }
+    }
+
+    NodeId finish(NodeId goal) {
+        this->statistics.peak_nodes = peak;
+        this->statistics.peak_memory = peak_memory();
+        return EngineBase<P>::finish(goal);
+    }
+
+    NodeId emit_path(NodeId goal) {
+        std::vector<NodeId> path;
+        for (NodeId id = goal; id != NO_NODE; id = pool[id].parent) {
+            path.push_back(id);
+        }
+        this->arena.clear();
+        NodeId parent = NO_NODE;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            Entry &entry = pool[*it];
+            parent = this->arena.emplace(std::move(*entry.state), entry.g, entry.h, parent, entry.action);
+        }
+        return parent;
+    }
+};
+
+#endif // ENGINE_MEMORY_BOUNDED_H
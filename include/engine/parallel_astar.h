@@ -0,0 +1,364 @@
+/**
+ * @file parallel_astar.h
+ * @brief Hash-distributed parallel A* (HDA*).
+ */
+
+#ifndef ENGINE_PARALLEL_ASTAR_H
+#define ENGINE_PARALLEL_ASTAR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+#include "frontier.h"
+
+/**
+ * @brief Parallel A* in which every state is owned by one worker thread.
+ *
+ * A state's hash picks its owner, which alone keeps that state's best-g record, open entry and closed flag, so duplicate detection needs no locks.
+ * Successors owned by another worker are buffered per destination and handed over in batches through lock-free inboxes.
+ *
+ * A goal popped by any worker becomes the incumbent solution. Workers drop nodes whose f is not below the incumbent cost
+ * and go idle when they have nothing better left. The search ends when a single counter of active workers plus in-flight messages reaches zero,
+ * at which point no open node anywhere can improve on the incumbent, so the result is optimal for an admissible heuristic.
+ *
+ * Every worker checks the engine's limits before each expansion through a SharedBudget; the first limit reached stops all workers,
+ * and the search returns NO_NODE with the reason in stats().status, as the serial A* does.
+ *
+ * The problem's expand, h, hash and equal must be safe to call from several threads at once.
+ */
+template <SearchProblem P>
+class ParallelAStar : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem to solve.
+     * @param threads Number of workers; 0 uses the hardware concurrency.
+     * @param frontier Priority queue used by every worker.
+     */
+    explicit ParallelAStar(const P &problem, unsigned threads = 0, FrontierKind frontier = FrontierKind::AUTO)
+        : EngineBase<P>(problem), threads(threads), frontier(frontier) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), which then holds only the solution path, or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        FrontierKind kind = frontier;
+        if (kind == FrontierKind::AUTO) {
+            kind = declares_integral_costs(this->problem) ? FrontierKind::BUCKET : FrontierKind::INDEXED_HEAP;
+        }
+        switch (kind) {
+            case FrontierKind::BUCKET:
+                return run<BucketFrontier>();
+            case FrontierKind::BINARY_HEAP:
+                return run<BinaryHeapFrontier>();
+            default:
+                return run<IndexedHeapFrontier>();
+        }
+    }
+
+    /// Number of workers the last search used.
+    unsigned worker_count() const { return static_cast<unsigned>(expansions.size()); }
+
+    /// Node expansions of each worker in the last search.
+    const std::vector<std::size_t> &worker_expansions() const { return expansions; }
+
+    unsigned threads;
+    FrontierKind frontier;
+
+private:
+    static constexpr std::size_t BATCH_SIZE = 64;
+    static constexpr std::uint64_t NO_REF = ~std::uint64_t(0);
+
+    // Nodes are addressed across workers by (worker << 32 | index in that worker's arena)
+    static std::uint64_t make_ref(std::size_t worker, NodeId id) { return (std::uint64_t(worker) << 32) | id; }
+
+    struct WorkerNode {
+        state_type state;
+        double path_cost;
+        double heuristic;
+        std::uint64_t parent;
+        ActionId action;
+    };
+
+    struct Message {
+        state_type state;
+        double path_cost;
+        std::uint64_t parent;
+        ActionId action;
+    };
+
+    struct Batch {
+        std::vector<Message> messages;
+        Batch *next = nullptr;
+    };
+
+    /// Multi-producer single-consumer stack of message batches.
+    class Inbox {
+    public:
+        void push(Batch *batch) {
+            batch->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+        Batch *take_all() { return head.exchange(nullptr, std::memory_order_acquire); }
+
+    private:
+        std::atomic<Batch *> head{nullptr};
+    };
+
+    struct Record {
+        double g;
+        std::uint32_t slot;
+        bool closed;
+        double h;  // Evaluated once, when the state first arrives
+    };
+
+    template <class Frontier>
+    struct Worker {
+        explicit Worker(const P &problem, std::size_t workers)
+            : best_g(0, ProblemHash<P>{&problem}, ProblemEqual<P>{&problem}), outboxes(workers) {}
+        NodeArena<WorkerNode> arena;
+        Frontier open;
+        std::unordered_map<state_type, Record, ProblemHash<P>, ProblemEqual<P>> best_g;
+        std::vector<std::vector<Message>> outboxes;
+        Inbox inbox;
+        SuccessorBuffer<state_type> successors;
+        SearchStats stats;
+        SharedBudget::Account account;
+        std::size_t expanded = 0;
+
+        /// Bytes of the worker's nodes, records and frontier.
+        std::size_t memory_usage() const {
+            return arena.memory_usage() + best_g.size() * (sizeof(state_type) + sizeof(Record) + 2 * sizeof(void *)) +
+                   stats.peak_frontier * sizeof(FrontierEntry);
+        }
+    };
+
+    std::vector<std::size_t> expansions;
+    std::atomic<std::int64_t> outstanding{0};  // Active workers plus messages in flight
+    std::atomic<double> incumbent{std::numeric_limits<double>::infinity()};
+    std::uint64_t goal_ref = NO_REF;
+    std::mutex goal_mutex;
+
+    std::size_t owner(const state_type &state, std::size_t workers) const {
+        // Scramble the problem's hash so ownership is independent of the buckets used inside each worker
+        std::uint64_t key = this->problem.hash(state);
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<std::size_t>(key % workers);
+    }
+
+    template <class Frontier>
+    void insert(Worker<Frontier> &worker, Message &&message) {
+        auto slot = static_cast<std::uint32_t>(worker.best_g.size());
+        auto [known, inserted] = worker.best_g.try_emplace(message.state, Record{message.path_cost, slot, false, 0.0});
+        if (inserted) {
+            known->second.h = this->heuristic(message.state, worker.stats);
+        } else {
+            if (message.path_cost >= known->second.g) {
+                worker.stats.count_duplicate();
+                return;
+            }
+            known->second.g = message.path_cost;
+            known->second.closed = false;
+            slot = known->second.slot;
+        }
+        double heuristic = known->second.h;
+        double f = message.path_cost + heuristic;
+        if (f >= incumbent.load(std::memory_order_relaxed)) {
+            return;
+        }
+        NodeId id = worker.arena.emplace(std::move(message.state), message.path_cost, heuristic, message.parent, message.action);
+        PhaseTimer timer(worker.stats.queue_seconds, this->phase_timers);
+        worker.open.push(id, slot, f, heuristic);
+        worker.stats.track_frontier(worker.open.size());
+    }
+
+    template <class Frontier>
+    void flush(std::vector<std::unique_ptr<Worker<Frontier>>> &workers, std::size_t self, bool all) {
+        for (std::size_t to = 0; to < workers.size(); to++) {
+            auto &outbox = workers[self]->outboxes[to];
+            if (outbox.empty() || (!all && outbox.size() < BATCH_SIZE)) {
+                continue;
+            }
+            auto *batch = new Batch;
+            batch->messages.swap(outbox);
+            // Count the messages before they become visible so the termination counter never reads zero while they are in flight
+            outstanding.fetch_add(static_cast<std::int64_t>(batch->messages.size()));
+            workers[to]->inbox.push(batch);
+        }
+    }
+
+    template <class Frontier>
+    void work(std::vector<std::unique_ptr<Worker<Frontier>>> &workers, std::size_t self, SharedBudget &budget) {
+        Worker<Frontier> &worker = *workers[self];
+        bool idle = false;
+        std::size_t since_flush = 0;
+        while (true) {
+            if (Batch *batch = worker.inbox.take_all()) {
+                if (idle) {
+                    outstanding.fetch_add(1);
+                    idle = false;
+                }
+                std::int64_t received = 0;
+                while (batch) {
+                    for (auto &message : batch->messages) {
+                        insert(worker, std::move(message));
+                    }
+                    received += static_cast<std::int64_t>(batch->messages.size());
+                    Batch *next = batch->next;
+                    delete batch;
+                    batch = next;
+                }
+                outstanding.fetch_sub(received);
+            }
+
+            if (idle) {
+                if (outstanding.load() == 0 || budget.stopped()) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Find the next node worth expanding
+            NodeId node = NO_NODE;
+            while (!worker.open.empty()) {
+                NodeId candidate;
+                {
+                    PhaseTimer timer(worker.stats.queue_seconds, this->phase_timers);
+                    candidate = worker.open.pop();
+                }
+                const WorkerNode &record = worker.arena[candidate];
+                Record &best = worker.best_g.find(record.state)->second;
+                if (record.path_cost > best.g || best.closed) {
+                    continue;
+                }
+                if (record.path_cost + record.heuristic >= incumbent.load(std::memory_order_relaxed)) {
+                    // The lowest f left cannot beat the incumbent, and neither can anything behind it
+                    worker.open.clear();
+                    break;
+                }
+                node = candidate;
+                break;
+            }
+
+            if (node == NO_NODE) {
+                flush(workers, self, true);
+                idle = true;
+                outstanding.fetch_sub(1);
+                continue;
+            }
+
+            const WorkerNode &record = worker.arena[node];
+            if (this->problem.is_goal(record.state)) {
+                std::lock_guard<std::mutex> lock(goal_mutex);
+                if (record.path_cost < incumbent.load()) {
+                    incumbent.store(record.path_cost);
+                    goal_ref = make_ref(self, node);
+                }
+                continue;
+            }
+            if (budget.spend(worker.account, record.path_cost + record.heuristic, [&worker] { return worker.memory_usage(); })) {
+                return;
+            }
+            worker.best_g.find(record.state)->second.closed = true;
+
+            worker.expanded++;
+            worker.successors.clear();
+            this->expand(record.state, worker.successors, worker.stats);
+            double path_cost = record.path_cost;
+            for (auto &successor : worker.successors) {
+                Message message{std::move(successor.state), path_cost + successor.cost, make_ref(self, node), successor.action};
+                std::size_t to = owner(message.state, workers.size());
+                if (to == self) {
+                    insert(worker, std::move(message));
+                } else {
+                    worker.outboxes[to].push_back(std::move(message));
+                }
+            }
+            flush(workers, self, ++since_flush % 16 == 0);
+        }
+    }
+
+    template <class Frontier>
+    NodeId run() {
+        this->begin_search();
+        std::size_t count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::unique_ptr<Worker<Frontier>>> workers;
+        for (std::size_t i = 0; i < count; i++) {
+            workers.push_back(std::make_unique<Worker<Frontier>>(this->problem, count));
+        }
+        incumbent.store(std::numeric_limits<double>::infinity());
+        goal_ref = NO_REF;
+        outstanding.store(static_cast<std::int64_t>(count));
+        SharedBudget budget(this->limits);
+        workers[0]->account.reports = true;
+
+        state_type root = this->problem.initial();
+        std::size_t root_owner = owner(root, count);
+        insert(*workers[root_owner], Message{std::move(root), 0.0, NO_REF, ActionId{0}});
+
+        std::vector<std::thread> pool;
+        for (std::size_t i = 1; i < count; i++) {
+            pool.emplace_back([this, &workers, &budget, i] { work(workers, i, budget); });
+        }
+        work(workers, 0, budget);
+        for (auto &thread : pool) {
+            thread.join();
+        }
+        this->stop_reason = budget.reason();
+
+        expansions.clear();
+        std::size_t peak_frontier = 0;
+        std::size_t peak_nodes = 0;
+        std::size_t peak_memory = 0;
+        for (auto &worker : workers) {
+            expansions.push_back(worker->expanded);
+            this->statistics += worker->stats;
+            // Workers peak at different times, so the sums are upper bounds
+            peak_frontier += worker->stats.peak_frontier;
+            peak_nodes += worker->arena.size();
+            peak_memory += worker->arena.memory_usage() + worker->stats.peak_frontier * sizeof(FrontierEntry);
+            // A stopped search leaves messages behind
+            for (Batch *batch = worker->inbox.take_all(); batch;) {
+                Batch *next = batch->next;
+                delete batch;
+                batch = next;
+            }
+        }
+        this->statistics.peak_frontier = peak_frontier;
+        this->statistics.peak_nodes = peak_nodes;
+        this->statistics.peak_memory = peak_memory;
+
+        // Copy the solution path into the engine's arena so callers read it like any other engine's result
+        this->arena.clear();
+        if (goal_ref == NO_REF || this->stop_reason) {
+            return this->finish(NO_NODE);
+        }
+        std::vector<WorkerNode *> path;
+        for (std::uint64_t ref = goal_ref; ref != NO_REF;) {
+            WorkerNode &node = workers[ref >> 32]->arena[static_cast<NodeId>(ref & 0xffffffffu)];
+            path.push_back(&node);
+            ref = node.parent;
+        }
+        NodeId parent = NO_NODE;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            parent = this->arena.emplace(std::move((*it)->state), (*it)->path_cost, (*it)->heuristic, parent, (*it)->action);
+        }
+        return this->finish(parent);
+    }
+};
+
+#endif // ENGINE_PARALLEL_ASTAR_H
@@ -0,0 +1,316 @@
+/**
+ * @file parallel_bfs.h
+ * @brief Level-synchronous parallel breadth-first search.
+ */
+
+#ifndef ENGINE_PARALLEL_BFS_H
+#define ENGINE_PARALLEL_BFS_H
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "engine.h"
+#include "../visited_set.h"
+
+/**
+ * @brief Breadth-first search that expands each layer with several threads.
+ *
+ * Layers are processed one at a time in four phases separated by barriers:
+ * 1. threads take chunks of the current layer, test for goals, expand the nodes and claim their children in a ConcurrentVisitedSet,
+ * 2. threads mark the children that won their claim and count each chunk's survivors,
+ * 3. one thread turns the counts into each chunk's offset in the next layer and reserves the whole layer in the arena,
+ * 4. threads move each chunk's survivors into its range of the arena.
+ * States without a default constructor cannot be filled in place, so for them the survivors are appended in phase 3 instead.
+ *
+ * A child's claim rank is its parent's node id followed by its position among the parent's successors, which is the order a serial BFS
+ * would generate it in. Duplicates therefore resolve exactly as in BFS, the layers come out in the same order, and the goal returned is
+ * the first one BFS would pop, whatever the thread count or scheduling. Like BFS, it never evaluates the heuristic.
+ *
+ * The engine's limits are checked at every barrier, so a search may run up to one layer past its node, time or memory limit
+ * before it stops and returns NO_NODE with the reason in stats().status.
+ *
+ * The problem's expand, is_goal, hash and equal must be safe to call from several threads at once. An exception thrown on any
+ * thread, std::bad_alloc included, stops the search and is rethrown from search().
+ */
+template <SearchProblem P>
+class ParallelBFS : public EngineBase<P> {
+public:
+    using state_type = typename P::state_type;
+    using node_type = typename EngineBase<P>::node_type;
+
+    /**
+     * @param problem The problem to solve.
+     * @param threads Number of threads; 0 uses the hardware concurrency.
+     * @param eliminate_duplicates Skip children whose state was already generated.
+     */
+    explicit ParallelBFS(const P &problem, unsigned threads = 0, bool eliminate_duplicates = true)
+        : EngineBase<P>(problem), threads(threads), eliminate_duplicates(eliminate_duplicates) {}
+
+    /**
+     * @brief Runs the search.
+     *
+     * @return The goal node in nodes(), or NO_NODE if no solution exists.
+     */
+    NodeId search() {
+        this->begin_search();
+        std::size_t count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        ConcurrentVisitedSet<P> visited(this->problem);
+        NodeId root = this->add_root(0.0);
+        if (eliminate_duplicates) {
+            visited.claim(this->arena[root].state, 0);
+        }
+
+        Layer current;
+        Layer next;
+        current.nodes.push_back(root);
+        current.split();
+        std::vector<SuccessorBuffer<state_type>> buffers(count);
+        std::vector<SearchStats> stats(count);
+        std::atomic<std::size_t> next_chunk{0};
+        std::atomic<std::size_t> goal_index{NOT_FOUND};
+        NodeId goal = NO_NODE;
+        NodeId first_new = NO_NODE;
+        Phase phase = Phase::EXPAND;
+        bool done = false;
+        std::atomic<bool> failed{false};
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        SharedBudget budget(this->limits);
+        std::uint64_t expanded = 0;
+
+        auto fail = [&](std::exception_ptr error) noexcept {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure) {
+                failure = error;
+            }
+            failed = true;
+        };
+
+        auto out_of_budget = [&]() noexcept {
+            try {
+                std::size_t memory =
+                    this->arena.memory_usage() + visited.memory_usage() + current.nodes.size() * sizeof(NodeId);
+                double depth = current.nodes.empty() ? 0.0 : this->arena[current.nodes.front()].path_cost;
+                return budget.check(expanded, depth, memory, true);
+            } catch (...) {
+                fail(std::current_exception());
+                return true;
+            }
+        };
+
+        // Runs on one thread between phases, so it only does bookkeeping that cannot throw
+        auto between_phases = [&]() noexcept {
+            next_chunk = 0;
+            if (failed) {
+                done = true;
+                return;
+            }
+            switch (phase) {
+            case Phase::EXPAND:
+                expanded += current.nodes.size();
+                if (goal_index != NOT_FOUND) {
+                    goal = current.nodes[goal_index];
+                    done = true;
+                } else {
+                    done = out_of_budget();
+                }
+                phase = Phase::MARK;
+                break;
+            case Phase::MARK:
+                phase = Phase::RESERVE;
+                break;
+            case Phase::RESERVE:
+                phase = Phase::MOVE;
+                break;
+            case Phase::MOVE:
+                std::swap(current, next);
+                this->statistics.track_frontier(current.nodes.size());
+                done = current.nodes.empty() || out_of_budget();
+                phase = Phase::EXPAND;
+                break;
+            }
+        };
+
+        std::barrier sync(static_cast<std::ptrdiff_t>(count), between_phases);
+
+        // Gives every chunk the range its survivors take in the next layer, and sizes the next layer and the arena to hold them
+        auto reserve = [&]() {
+            for (std::size_t c = 0; c < current.chunks.size(); c++) {
+                current.offsets[c + 1] += current.offsets[c];
+            }
+            next.nodes.resize(current.offsets.back());
+            next.split();
+            if constexpr (std::is_default_constructible_v<node_type>) {
+                first_new = this->arena.grow(next.nodes.size());
+            } else {
+                // Without a default constructor the nodes cannot be filled in place, so they are appended here instead
+                std::size_t index = 0;
+                for (auto &chunk : current.chunks) {
+                    for (auto &child : chunk) {
+                        if (child.keep) {
+                            next.nodes[index++] = this->add_child(child.parent, child.successor, child.path_cost, 0.0);
+                        }
+                    }
+                }
+            }
+        };
+
+        auto move_survivors = [&](std::size_t c) {
+            if constexpr (std::is_default_constructible_v<node_type>) {
+                std::size_t index = current.offsets[c];
+                for (auto &child : current.chunks[c]) {
+                    if (child.keep) {
+                        auto id = static_cast<NodeId>(first_new + index);
+                        this->arena[id] =
+                            node_type{std::move(child.successor.state), child.path_cost, 0.0, child.parent, child.successor.action};
+                        next.nodes[index++] = id;
+                    }
+                }
+            }
+        };
+
+        auto work = [&](std::size_t self) {
+            SuccessorBuffer<state_type> &successors = buffers[self];
+            try {
+                while (true) {
+                    for (std::size_t c = next_chunk++; c < current.chunks.size(); c = next_chunk++) {
+                        std::size_t end = std::min(current.nodes.size(), (c + 1) * CHUNK_SIZE);
+                        for (std::size_t i = c * CHUNK_SIZE; i < end; i++) {
+                            if (i > goal_index.load(std::memory_order_relaxed)) {
+                                break;
+                            }
+                            expand_into(current.nodes[i], i, goal_index, successors, stats[self], visited, current.chunks[c]);
+                        }
+                    }
+                    sync.arrive_and_wait();
+                    if (done) {
+                        return;
+                    }
+
+                    for (std::size_t c = next_chunk++; c < current.chunks.size(); c = next_chunk++) {
+                        std::size_t kept = 0;
+                        for (auto &child : current.chunks[c]) {
+                            child.keep = !eliminate_duplicates || visited.claimed_by(child.successor.state, child.rank);
+                            if (child.keep) {
+                                kept++;
+                            } else {
+                                stats[self].count_duplicate();
+                            }
+                        }
+                        current.offsets[c + 1] = kept;
+                    }
+                    sync.arrive_and_wait();
+                    if (done) {
+                        return;
+                    }
+
+                    if (self == 0) {
+                        reserve();
+                    }
+                    sync.arrive_and_wait();
+                    if (done) {
+                        return;
+                    }
+
+                    for (std::size_t c = next_chunk++; c < current.chunks.size(); c = next_chunk++) {
+                        move_survivors(c);
+                    }
+                    sync.arrive_and_wait();
+                    if (done) {
+                        return;
+                    }
+                }
+            } catch (...) {
+                // Leave the barrier so the other threads see the failure at the end of this phase and stop
+                fail(std::current_exception());
+                sync.arrive_and_drop();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (std::size_t i = 1; i < count; i++) {
+            pool.emplace_back(work, i);
+        }
+        work(0);
+        for (auto &thread : pool) {
+            thread.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        for (auto &worker : stats) {
+            this->statistics += worker;
+        }
+        this->stop_reason = budget.reason();
+        return this->finish(goal, sizeof(NodeId));
+    }
+
+    unsigned threads;
+    bool eliminate_duplicates;
+
+private:
+    static constexpr std::size_t CHUNK_SIZE = 256;
+    static constexpr std::size_t NOT_FOUND = std::numeric_limits<std::size_t>::max();
+
+    struct Child {
+        NodeId parent;
+        std::uint64_t rank;
+        double path_cost;
+        bool keep;
+        Successor<state_type> successor;
+    };
+
+    enum class Phase { EXPAND, MARK, RESERVE, MOVE };
+
+    /// A layer's nodes with the children generated from each of its chunks.
+    struct Layer {
+        std::vector<NodeId> nodes;
+        std::vector<std::vector<Child>> chunks;
+        std::vector<std::size_t> offsets;  // Survivors of each chunk, turned into their first index in the next layer
+
+        /// Sizes the chunks and offsets for the nodes.
+        void split() {
+            chunks.resize((nodes.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+            for (auto &chunk : chunks) {
+                chunk.clear();
+            }
+            offsets.assign(chunks.size() + 1, 0);
+        }
+    };
+
+    void expand_into(NodeId node, std::size_t index, std::atomic<std::size_t> &goal_index, SuccessorBuffer<state_type> &successors,
+                     SearchStats &stats, ConcurrentVisitedSet<P> &visited, std::vector<Child> &out) const {
+        const auto &record = this->arena[node];
+        if (this->problem.is_goal(record.state)) {
+            // Keep the goal BFS would pop first: the lowest index in the layer
+            std::size_t seen = goal_index.load();
+            while (index < seen && !goal_index.compare_exchange_weak(seen, index)) {
+            }
+            return;
+        }
+        if (goal_index.load(std::memory_order_relaxed) != NOT_FOUND) {
+            return; // This layer's children will never be needed
+        }
+        successors.clear();
+        this->expand(record.state, successors, stats);
+        std::uint64_t position = 0;
+        for (auto &successor : successors) {
+            // Parent ids grow from layer to layer, so ranks order children exactly as a serial BFS generates them; the root holds rank 0
+            std::uint64_t rank = (std::uint64_t(node) + 1) << 32 | position++;
+            if (eliminate_duplicates && !visited.claim(successor.state, rank)) {
+                stats.count_duplicate();
+                continue;
+            }
+            out.push_back(Child{node, rank, record.path_cost + successor.cost, false, std::move(successor)});
+        }
+    }
+};
+
+#endif // ENGINE_PARALLEL_BFS_H
@@ -0,0 +1,270 @@
+/**
+ * @file pattern_database.h
+ * @brief Pattern database heuristics: abstract distance tables built once, stored compactly on disk and memory-mapped to load.
+ */
+
+#ifndef ENGINE_PATTERN_DATABASE_H
+#define ENGINE_PATTERN_DATABASE_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "engine.h"
+#include "../mapped_file.h"
+
+/**
+ * @brief An abstraction of a problem that a pattern database can enumerate.
+ *
+ * Abstract states are numbered from 0 to `size() - 1`. `goals(out)` appends the abstract goal states and `predecessors(rank, out)`
+ * appends every abstract state with an action leading to `rank`. For the table to be admissible, every action of the problem must
+ * map to an abstract action (or stay inside one abstract state), and every goal state to an abstract goal.
+ */
+template <class A>
+concept PatternAbstraction = requires(const A &abstraction, std::size_t rank, std::vector<std::size_t> &out) {
+    { abstraction.size() } -> std::convertible_to<std::size_t>;
+    abstraction.goals(out);
+    abstraction.predecessors(rank, out);
+};
+
+/**
+ * @brief An abstraction that also maps the problem's states onto its abstract states with `rank(state)`.
+ */
+template <class A, class S>
+concept AbstractionOf = PatternAbstraction<A> && requires(const A &abstraction, const S &state) {
+    { abstraction.rank(state) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief Table of abstract goal distances, in abstract actions, for every state of an abstraction.
+ *
+ * Built by a backward breadth-first search from the abstract goals, then packed into 4-bit entries when every distance fits
+ * and 8-bit entries otherwise. The largest entry value stands for "at least that far", which also covers unreachable abstract states,
+ * so lookups stay admissible when distances are saturated.
+ *
+ * save() writes the table as a small header followed by the packed entries, and the path constructor memory-maps such a file,
+ * so loading costs no parsing and pages are read only when looked up. Files use the byte order of the machine that wrote them.
+ */
+class PatternDatabase {
+public:
+    /**
+     * @brief Enumerates an abstraction backwards from its goals.
+     *
+     * @param abstraction The abstract space.
+     * @param bits Bits per entry, 4 or 8; 0 picks 4 when every reachable distance fits and 8 otherwise.
+     * @throws std::invalid_argument if bits is not 0, 4 or 8.
+     */
+    template <PatternAbstraction A>
+    static PatternDatabase build(const A &abstraction, unsigned bits = 0) {
+        if (bits != 0 && bits != 4 && bits != 8) {
+            throw std::invalid_argument("Pattern database entries have 4 or 8 bits");
+        }
+        std::size_t entries = abstraction.size();
+        // Distances saturate at 255, which also marks states not reached yet
+        std::vector<std::uint8_t> distance(entries, 0xff);
+        std::vector<std::size_t> layer;
+        std::vector<std::size_t> next;
+        std::vector<std::size_t> predecessors;
+        abstraction.goals(layer);
+        for (std::size_t rank : layer) {
+            distance[rank] = 0;
+        }
+        unsigned depth = 0;
+        while (!layer.empty() && depth + 1 < 0xff) {
+            depth++;
+            next.clear();
+            for (std::size_t rank : layer) {
+                predecessors.clear();
+                abstraction.predecessors(rank, predecessors);
+                for (std::size_t predecessor : predecessors) {
+                    if (distance[predecessor] == 0xff) {
+                        distance[predecessor] = static_cast<std::uint8_t>(depth);
+                        next.push_back(predecessor);
+                    }
+                }
+            }
+            layer.swap(next);
+        }
+        if (bits == 0) {
+            // The BFS ran dry at depth, so the farthest reachable state is depth - 1 actions away
+            bits = layer.empty() && depth <= 0x10 ? 4 : 8;
+        }
+
+        PatternDatabase database;
+        database.header = Header::make(bits, entries);
+        database.owned.assign(table_bytes(bits, entries), 0);
+        std::uint8_t cap = bits == 4 ? 0x0f : 0xff;
+        for (std::size_t rank = 0; rank < entries; rank++) {
+            std::uint8_t value = std::min(distance[rank], cap);
+            if (bits == 4) {
+                database.owned[rank / 2] |= static_cast<std::uint8_t>(value << (rank % 2 * 4));
+            } else {
+                database.owned[rank] = value;
+            }
+        }
+        database.table = database.owned.data();
+        return database;
+    }
+
+    /**
+     * @brief Maps a file written by save().
+     *
+     * @throws std::runtime_error if the file cannot be mapped or is not a pattern database of the size its header claims.
+     */
+    explicit PatternDatabase(const std::string &path) : file(std::make_unique<MappedFile>(path)) {
+        if (file->size() < sizeof(Header)) {
+            throw std::runtime_error("Truncated pattern database " + path);
+        }
+        std::memcpy(&header, file->data(), sizeof(Header));
+        if (std::memcmp(header.magic, Header::MAGIC, sizeof(header.magic)) != 0 || (header.bits != 4 && header.bits != 8)) {
+            throw std::runtime_error("Not a pattern database: " + path);
+        }
+        if (file->size() != sizeof(Header) + table_bytes(header.bits, header.entries)) {
+            throw std::runtime_error("Pattern database " + path + " does not match its header");
+        }
+        table = reinterpret_cast<const std::uint8_t *>(file->data() + sizeof(Header));
+    }
+
+    PatternDatabase(PatternDatabase &&) = default;
+    PatternDatabase &operator=(PatternDatabase &&) = default;
+
+    /**
+     * @brief Writes the header and the packed table.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        out.write(reinterpret_cast<const char *>(table), static_cast<std::streamsize>(table_bytes(header.bits, header.entries)));
+        if (!out) {
+            throw std::runtime_error("Cannot write pattern database " + path);
+        }
+    }
+
+    /// Abstract actions from an abstract state to the nearest abstract goal, capped at max_distance().
+    unsigned distance(std::size_t rank) const {
+        if (header.bits == 4) {
+            return table[rank / 2] >> (rank % 2 * 4) & 0x0f;
+        }
+        return table[rank];
+    }
+
+    /// Number of abstract states.
+    std::size_t size() const { return header.entries; }
+
+    /// Bits per entry, 4 or 8.
+    unsigned bits() const { return header.bits; }
+
+    /// The saturated entry value: the distance is at least this, or the state cannot reach a goal.
+    unsigned max_distance() const { return header.bits == 4 ? 0x0f : 0xff; }
+
+    /// Bytes taken by the table, without the file header.
+    std::size_t bytes() const { return table_bytes(header.bits, header.entries); }
+
+    /// Whether the table is read from a memory-mapped file rather than held in memory.
+    bool mapped() const { return file != nullptr; }
+
+private:
+    struct Header {
+        static constexpr char MAGIC[8] = {'S', 'Y', 'M', 'P', 'D', 'B', '0', '1'};
+        char magic[8];
+        std::uint32_t bits;
+        std::uint32_t reserved;
+        std::uint64_t entries;
+
+        static Header make(unsigned bits, std::size_t entries) {
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.bits = bits;
+            header.entries = entries;
+            return header;
+        }
+    };
+
+    PatternDatabase() = default;
+
+    static std::size_t table_bytes(unsigned bits, std::size_t entries) { return bits == 4 ? (entries + 1) / 2 : entries; }
+
+    Header header{};
+    std::vector<std::uint8_t> owned;    // Table of a database built in this process
+    std::unique_ptr<MappedFile> file;   // Mapping of a loaded database
+    const std::uint8_t *table = nullptr;
+};
+
+/**
+ * @brief How PatternHeuristic combines the lookups of several pattern databases.
+ */
+enum class PatternCombine {
+    MAX, ///< The largest lookup; admissible for any set of admissible databases
+    ADD, ///< The sum of the lookups; admissible only when no action of the problem is counted by more than one abstraction
+};
+
+/**
+ * @brief Wraps a problem so that its heuristic comes from pattern database lookups.
+ *
+ * Each database is added with the abstraction it was built from, which maps the problem's states to table entries,
+ * and with the cost of one abstract action, normally the cheapest action cost of the problem.
+ * The lookups are combined by max or sum, and by default the result is also maxed with the problem's own heuristic.
+ * Every other member is forwarded to the problem (see ProblemAdapter). The databases and abstractions must outlive the adapter.
+ */
+template <SearchProblem P>
+class PatternHeuristic : public ProblemAdapter<P> {
+public:
+    using state_type = typename P::state_type;
+
+    /**
+     * @param problem The problem to guide.
+     * @param combine How lookups of different databases are combined.
+     * @param with_problem_h Also take the maximum with the problem's own h.
+     */
+    explicit PatternHeuristic(const P &problem, PatternCombine combine = PatternCombine::MAX, bool with_problem_h = true)
+        : ProblemAdapter<P>(problem), combine(combine), with_problem_h(with_problem_h) {}
+
+    /**
+     * @brief Adds a database to the heuristic.
+     *
+     * @param database A table built from the abstraction.
+     * @param abstraction Maps the problem's states onto the database's entries.
+     * @param step_cost Cost of one abstract action; the lookup is the abstract distance times this.
+     * @throws std::invalid_argument if the database and the abstraction differ in size.
+     */
+    template <AbstractionOf<typename P::state_type> A>
+    void add(const PatternDatabase &database, const A &abstraction, double step_cost = 1.0) {
+        if (database.size() != abstraction.size()) {
+            throw std::invalid_argument("Pattern database was not built from this abstraction");
+        }
+        parts.push_back(Part{&database, [&abstraction](const state_type &state) -> std::size_t { return abstraction.rank(state); },
+                             step_cost});
+    }
+
+    /// The combined lookups, and the problem's own h when with_problem_h is set.
+    double h(const state_type &state) const {
+        double value = 0.0;
+        for (const Part &part : parts) {
+            double lookup = part.step_cost * part.database->distance(part.rank(state));
+            value = combine == PatternCombine::ADD ? value + lookup : std::max(value, lookup);
+        }
+        return with_problem_h ? std::max(value, this->problem().h(state)) : value;
+    }
+
+    PatternCombine combine;
+    bool with_problem_h;
+
+private:
+    struct Part {
+        const PatternDatabase *database;
+        std::function<std::size_t(const state_type &)> rank;
+        double step_cost;
+    };
+
+    std::vector<Part> parts;
+};
+
+#endif // ENGINE_PATTERN_DATABASE_H
@@ -0,0 +1,60 @@
+/**
+ * @file virtual_problem.h
+ * @brief Adapter that runs problems written against the abstract Problem class through the templated engines.
+ */
+
+#ifndef VIRTUAL_PROBLEM_H
+#define VIRTUAL_PROBLEM_H
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include "../definitions.h"
+#include "engine.h"
+
+/**
+ * @brief Exposes a Problem through the SearchProblem interface.
+ *
+ * States and actions stay behind shared pointers and every call goes through the Problem's virtual methods,
+ * which is what the Search classes have always done. Problems known at compile time should implement SearchProblem directly instead.
+ */
+class VirtualProblem {
+public:
+    using state_type = std::shared_ptr<State>;
+
+    explicit VirtualProblem(Problem *problem) : problem(problem) {}
+
+    state_type initial() const {
+        // Non-owning pointer: the problem keeps ownership of its initial state
+        return state_type(state_type(), problem->initial_state());
+    }
+
+    bool is_goal(const state_type &state) const { return problem->goal_test(state.get()); }
+
+    double h(const state_type &state) const { return problem->heuristic(state.get()); }
+
+    void h_batch(std::span<const Successor<state_type>> successors, std::span<double> out) const { problem->heuristic_batch(successors, out); }
+
+    std::size_t hash(const state_type &state) const { return state->hash(); }
+
+    bool equal(const state_type &a, const state_type &b) const { return a == b || a->equals(*b); }
+
+    bool pack(const state_type &state, std::uint64_t &key) const { return state->pack(key); }
+
+    bool integral_costs() const { return problem->integral_costs(); }
+
+    void expand(const state_type &state, SuccessorBuffer<state_type> &out) const { problem->expand(state, out); }
+
+    const std::string &action_name(ActionId action) const { return problem->action_name(action); }
+
+    state_type goal() const { return problem->goal_state(); }
+
+    void predecessors(const state_type &state, SuccessorBuffer<state_type> &out) const { problem->predecessors(state, out); }
+
+    double h_reverse(const state_type &state) const { return problem->reverse_heuristic(state.get()); }
+
+    Problem *problem;
+};
+
+#endif // VIRTUAL_PROBLEM_H
@@ -0,0 +1,71 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory-mapped files.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Maps a whole file into memory for reading.
+ *
+ * Pages are loaded by the OS on first access, so opening a large file is instant and only the parts that are read cost I/O.
+ * The mapping is released when the object is destroyed.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the file at the given path.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        if (length > 0) {
+            void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map " + path);
+            }
+            bytes = static_cast<const char *>(mapping);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        if (bytes) {
+            ::munmap(const_cast<char *>(bytes), length);
+        }
+    }
+
+    const char *data() const { return bytes; }
+    std::size_t size() const { return length; }
+    std::string_view view() const { return {bytes, length}; }
+
+private:
+    const char *bytes = nullptr;
+    std::size_t length = 0;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,141 @@
+/**
+ * @file node_arena.h
+ * @brief Chunked node storage owned by a search engine.
+ */
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Index of a node inside a NodeArena.
+using NodeId = std::uint32_t;
+
+/// Parent index of root nodes.
+constexpr NodeId NO_NODE = std::numeric_limits<NodeId>::max();
+
+/**
+ * @brief Append-only store for search nodes.
+ *
+ * Nodes live in fixed-size contiguous chunks, so adding a node never moves the ones already stored and references stay valid until clear().
+ * Nodes refer to their parent by 32-bit index rather than by pointer, and the whole tree is released in one pass when the search ends
+ * instead of through a chain of reference-count drops.
+ *
+ * @tparam T The node payload. It must expose a `NodeId parent` member for path reconstruction.
+ */
+template <class T>
+class NodeArena {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 4096;
+
+    /// Most nodes an arena holds: every index below NO_NODE, which marks a missing parent.
+    static constexpr std::size_t MAX_NODES = NO_NODE;
+
+    /**
+     * @brief Constructs a node in place.
+     *
+     * @return The index of the new node.
+     * @throws std::length_error if the arena already holds MAX_NODES nodes.
+     */
+    template <class... Args>
+    NodeId emplace(Args &&... args) {
+        check_room(1);
+        if (chunks.empty() || chunks.back().size() == CHUNK_SIZE) {
+            add_chunk();
+        }
+        chunks.back().push_back(T{std::forward<Args>(args)...});
+        return static_cast<NodeId>(count++);
+    }
+
+    /**
+     * @brief Appends count default-constructed nodes, to be filled in afterwards.
+     *
+     * The chunks are sized here, so the new nodes can then be assigned through operator[] from several threads at once.
+     *
+     * @return The index of the first new node; the others follow it.
+     * @throws std::length_error if the arena would hold more than MAX_NODES nodes.
+     */
+    NodeId grow(std::size_t count) requires std::is_default_constructible_v<T> {
+        check_room(count);
+        auto first = static_cast<NodeId>(this->count);
+        while (count > 0) {
+            if (chunks.empty() || chunks.back().size() == CHUNK_SIZE) {
+                add_chunk();
+            }
+            std::size_t taken = std::min(count, CHUNK_SIZE - chunks.back().size());
+            chunks.back().resize(chunks.back().size() + taken);
+            this->count += taken;
+            count -= taken;
+        }
+        return first;
+    }
+
+    T &operator[](NodeId id) { return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE]; }
+    const T &operator[](NodeId id) const { return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE]; }
+
+    std::size_t size() const { return count; }
+
+    /// Bytes reserved by the chunks in use, excluding memory owned by the payloads themselves and spare chunks kept by reset().
+    std::size_t memory_usage() const { return chunks.size() * CHUNK_SIZE * sizeof(T); }
+
+    /**
+     * @brief Collects the indices on the path from the root to a node.
+     *
+     * @param id The last node of the path.
+     * @return The node indices in root-to-node order.
+     */
+    std::vector<NodeId> path_to(NodeId id) const {
+        std::vector<NodeId> path;
+        for (NodeId current = id; current != NO_NODE; current = (*this)[current].parent) {
+            path.push_back(current);
+        }
+        return {path.rbegin(), path.rend()};
+    }
+
+    /// Releases every node at once.
+    void clear() {
+        chunks.clear();
+        spare.clear();
+        count = 0;
+    }
+
+    /// Destroys every node but keeps the chunks, so the next nodes are stored without allocating.
+    void reset() {
+        for (auto &chunk : chunks) {
+            chunk.clear();
+            spare.push_back(std::move(chunk));
+        }
+        chunks.clear();
+        count = 0;
+    }
+
+private:
+    std::vector<std::vector<T>> chunks;
+    std::vector<std::vector<T>> spare;  // Emptied chunks with their capacity, reused before allocating new ones
+    std::size_t count = 0;
+
+    void check_room(std::size_t added) const {
+        if (added > MAX_NODES - count) {
+            throw std::length_error("A node arena holds at most " + std::to_string(MAX_NODES) + " nodes");
+        }
+    }
+
+    void add_chunk() {
+        if (spare.empty()) {
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK_SIZE);
+        } else {
+            chunks.push_back(std::move(spare.back()));
+            spare.pop_back();
+        }
+    }
+};
+
+#endif // NODE_ARENA_H
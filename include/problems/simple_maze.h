@@ -5,97 +5,368 @@
 #ifndef SIMPLE_MAZE_H
 #define SIMPLE_MAZE_H
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "symphony.h"
+#include "../heuristic_kernels.h"
+#include "../mapped_file.h"
 
 
-class MazeState : public State {
-// use a 2D array to represent the maze
+/**
+ * @brief Immutable maze layout shared by every state of a MazeProblem.
+ *
+ * Cells are stored row-major in one flat array: 0 is free, 1 is a wall and -1 marks the goal.
+ * Coordinates follow the rest of the maze code: x is the row and y is the column.
+ */
+class MazeGrid {
 public:
-    MazeState() {
-        maze = {
-            {0, 0, 0, 0, 0},
-            {0, 1, 1, 1, 0},
-            {0, 1, -1, 0, 0},
-            {0, 1, 1, 1, 0},
-            {0, 0, 0, 0, 0}
+    static constexpr std::int8_t FREE = 0;
+    static constexpr std::int8_t WALL = 1;
+    static constexpr std::int8_t GOAL = -1;
+
+    MazeGrid(int rows, int cols) : rows(rows), cols(cols), cells(static_cast<std::size_t>(rows) * cols, FREE) {}
+
+    /**
+     * @brief Builds a grid from nested rows of cell values, taking the first GOAL cell as the goal.
+     */
+    explicit MazeGrid(const std::vector<std::vector<int>> &maze)
+        : MazeGrid(static_cast<int>(maze.size()), maze.empty() ? 0 : static_cast<int>(maze[0].size())) {
+        for (int x = 0; x < rows; x++) {
+            for (int y = 0; y < cols; y++) {
+                set(x, y, static_cast<std::int8_t>(maze[x][y]));
+            }
+        }
+    }
+
+    /**
+     * @brief Loads a map in the MovingAI benchmark format through a memory mapping.
+     *
+     * The file has a `type`, `height`, `width` and `map` header followed by one line per row.
+     * `.`, `G` and `S` cells are passable; everything else (`@`, `O`, `T`, `W`) is a wall.
+     * MovingAI maps carry no goal, so set one with set_goal().
+     *
+     * @throws std::runtime_error if the file cannot be read or is malformed.
+     */
+    static MazeGrid load_movingai(const std::string &path) {
+        MappedFile file(path);
+        std::string_view text = file.view();
+        std::size_t pos = 0;
+        auto next_line = [&]() {
+            std::size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            return line;
         };
-        x = 1;
-        y = 1;
+
+        int height = -1;
+        int width = -1;
+        while (pos < text.size()) {
+            std::string_view line = next_line();
+            if (line == "map") {
+                break;
+            }
+            if (line.rfind("height ", 0) == 0) {
+                height = std::atoi(std::string(line.substr(7)).c_str());
+            } else if (line.rfind("width ", 0) == 0) {
+                width = std::atoi(std::string(line.substr(6)).c_str());
+            }
+        }
+        if (height <= 0 || width <= 0) {
+            throw std::runtime_error("Missing map dimensions in " + path);
+        }
+
+        MazeGrid grid(height, width);
+        for (int x = 0; x < height; x++) {
+            std::string_view line = next_line();
+            if (static_cast<int>(line.size()) < width) {
+                throw std::runtime_error("Truncated map row in " + path);
+            }
+            for (int y = 0; y < width; y++) {
+                char c = line[y];
+                grid.set(x, y, (c == '.' || c == 'G' || c == 'S') ? FREE : WALL);
+            }
+        }
+        return grid;
+    }
+
+    std::int8_t at(int x, int y) const { return cells[index(x, y)]; }
+
+    bool passable(int x, int y) const { return x >= 0 && y >= 0 && x < rows && y < cols && at(x, y) != WALL; }
+
+    void set(int x, int y, std::int8_t value) {
+        cells[index(x, y)] = value;
+        if (value == GOAL && goal_x < 0) {
+            goal_x = x;
+            goal_y = y;
+        }
     }
-    MazeState(std::vector<std::vector<int>> maze, int x, int y) : maze(maze), x(x), y(y) {}
-    std::vector<std::vector<int>> maze;
+
+    /// Marks a cell as the goal used by the heuristic.
+    void set_goal(int x, int y) {
+        if (goal_x >= 0) {
+            cells[index(goal_x, goal_y)] = FREE;
+        }
+        goal_x = -1;
+        set(x, y, GOAL);
+    }
+
+    std::size_t index(int x, int y) const { return static_cast<std::size_t>(x) * cols + y; }
+
+    int rows;
+    int cols;
+    int goal_x = -1;
+    int goal_y = -1;
+
+private:
+    std::vector<std::int8_t> cells;
+};
+
+
+class MazeState final : public State {
+// the position of the agent; the maze itself lives once in the problem
+public:
+    MazeState() : x(1), y(1) {}
+    MazeState(int x, int y) : x(x), y(y) {}
     int x;
     int y;
     void print() override {
-        int row_index = 0;
-        for (auto &row : maze) {
-            int col_index = 0;
-            for (auto &cell : row) {
-                if (x == row_index && y == col_index) {
+        std::cout << "MazeState(" << x << ", " << y << ")" << std::endl;
+    }
+    std::size_t hash() const override {
+        return hash_combine(std::hash<int>{}(x), std::hash<int>{}(y));
+    }
+    bool operator==(const MazeState &other) const {
+        return x == other.x && y == other.y;
+    }
+    bool equals(const State &other) const override {
+        auto *maze_state = dynamic_cast<const MazeState *>(&other);
+        return maze_state && *maze_state == *this;
+    }
+    bool pack(std::uint64_t &key) const override {
+        key = (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+        return true;
+    }
+};
+
+
+class MazeProblem : public TypedProblem<MazeProblem, MazeState> {
+public:
+    enum Move : ActionId { UP, DOWN, LEFT, RIGHT };
+
+    MazeProblem()
+        : MazeProblem(std::make_shared<MazeGrid>(std::vector<std::vector<int>>{
+              {0, 0, 0, 0, 0},
+              {0, 1, 1, 1, 0},
+              {0, 1, -1, 0, 0},
+              {0, 1, 1, 1, 0},
+              {0, 0, 0, 0, 0}
+          }), 1, 1) {}
+
+    /**
+     * @brief Creates a maze problem on a shared grid.
+     *
+     * @param grid The maze layout. It must contain a goal cell.
+     * @param start_x Row of the start position.
+     * @param start_y Column of the start position.
+     */
+    MazeProblem(std::shared_ptr<MazeGrid> grid, int start_x, int start_y) : grid(std::move(grid)) {
+        initial_state_ = new MazeState(start_x, start_y);
+    }
+    ~MazeProblem() {
+    }
+
+    /// Moves the start position, e.g. as the agent follows its plan; incremental planners pick the change up in their next search.
+    void set_start(int x, int y) {
+        *static_cast<MazeState *>(initial_state_) = MazeState(x, y);
+    }
+
+    bool is_goal(const MazeState &state) const {
+        return grid->at(state.x, state.y) == MazeGrid::GOAL;
+    }
+
+    void expand(const MazeState &state, SuccessorBuffer<MazeState> &out) const {
+        if (grid->passable(state.x - 1, state.y)) {
+            out.emplace(UP, 1, state.x - 1, state.y);
+        }
+        if (grid->passable(state.x + 1, state.y)) {
+            out.emplace(DOWN, 1, state.x + 1, state.y);
+        }
+        if (grid->passable(state.x, state.y - 1)) {
+            out.emplace(LEFT, 1, state.x, state.y - 1);
+        }
+        if (grid->passable(state.x, state.y + 1)) {
+            out.emplace(RIGHT, 1, state.x, state.y + 1);
+        }
+    }
+
+    /// The grid's goal cell, where bidirectional search starts its backward half.
+    MazeState goal() const {
+        return MazeState(grid->goal_x, grid->goal_y);
+    }
+
+    // Moves are reversible: the cell below reaches this one by moving up, and so on. Nothing moves into a wall, so a wall has no
+    // predecessors, which keeps this the exact inverse of expand()
+    void predecessors(const MazeState &state, SuccessorBuffer<MazeState> &out) const {
+        if (!grid->passable(state.x, state.y)) {
+            return;
+        }
+        if (grid->passable(state.x + 1, state.y)) {
+            out.emplace(UP, 1, state.x + 1, state.y);
+        }
+        if (grid->passable(state.x - 1, state.y)) {
+            out.emplace(DOWN, 1, state.x - 1, state.y);
+        }
+        if (grid->passable(state.x, state.y + 1)) {
+            out.emplace(LEFT, 1, state.x, state.y + 1);
+        }
+        if (grid->passable(state.x, state.y - 1)) {
+            out.emplace(RIGHT, 1, state.x, state.y - 1);
+        }
+    }
+
+    const std::string &action_name(ActionId action) const override {
+        static const std::string names[] = {"Up", "Down", "Left", "Right"};
+        return names[action];
+    }
+
+    // Manhattan distance to the grid's goal
+    double h(const MazeState &state) const {
+        return std::abs(state.x - grid->goal_x) + std::abs(state.y - grid->goal_y);
+    }
+
+    // The same distances for a batch of successors: coordinates are gathered into arrays for the vectorized kernel
+    void h_batch(std::span<const Successor<MazeState>> successors, std::span<double> out) const {
+        constexpr std::size_t CHUNK = 64;
+        std::int32_t xs[CHUNK];
+        std::int32_t ys[CHUNK];
+        for (std::size_t start = 0; start < successors.size(); start += CHUNK) {
+            std::size_t count = std::min(CHUNK, successors.size() - start);
+            for (std::size_t i = 0; i < count; i++) {
+                xs[i] = successors[start + i].state.x;
+                ys[i] = successors[start + i].state.y;
+            }
+            batch_manhattan(xs, ys, count, grid->goal_x, grid->goal_y, out.data() + start);
+        }
+    }
+
+    // Manhattan distance from the start, for the backward half of bidirectional search
+    double h_reverse(const MazeState &state) const {
+        auto *start = static_cast<const MazeState *>(initial_state_);
+        return std::abs(state.x - start->x) + std::abs(state.y - start->y);
+    }
+
+    bool integral_costs() const override {
+        return true;
+    }
+
+    bool pack(const MazeState &state, std::uint64_t &key) const {
+        key = grid->index(state.x, state.y);
+        return true;
+    }
+
+    /**
+     * @brief Draws the maze with the agent's position marked V.
+     */
+    void print(const MazeState &state) const {
+        for (int x = 0; x < grid->rows; x++) {
+            for (int y = 0; y < grid->cols; y++) {
+                if (x == state.x && y == state.y) {
                     std::cout << "V";
-                    col_index++;
-                    continue;
-                }
-                if (cell == 0) {
+                } else if (grid->at(x, y) == MazeGrid::FREE) {
                     std::cout << " ";
-                } else if (cell == 1) {
+                } else if (grid->at(x, y) == MazeGrid::WALL) {
                     std::cout << "#";
-                } else if (cell == -1) {
+                } else {
                     std::cout << "X";
                 }
-                col_index++;
             }
-            row_index++;
             std::cout << std::endl;
         }
     }
+
+    std::shared_ptr<MazeGrid> grid;
 };
 
 
-class MazeProblem : public Problem {
+/**
+ * @brief Abstraction of a maze into square blocks of cells, for building a pattern database (see engine/pattern_database.h).
+ *
+ * Each block of block x block cells is one abstract state, and two neighbouring blocks are connected when a move crosses between them.
+ * A move never changes the block by more than one step, so the number of block steps to the goal's block never overestimates
+ * the moves left, while still seeing walls that the Manhattan distance ignores.
+ */
+class MazeBlockAbstraction {
 public:
-    MazeProblem() {
-        initial_state_ = new MazeState();
-    }
-    ~MazeProblem() {
-    }
-    bool goal_test(State *state) override {
-        auto *maze_state = dynamic_cast<MazeState *>(state);
-        return maze_state->maze[maze_state->x][maze_state->y] == -1;
-    }
+    /**
+     * @param grid The maze, with its goal set.
+     * @param block Side of a block in cells.
+     */
+    MazeBlockAbstraction(std::shared_ptr<const MazeGrid> grid, int block)
+        : grid(std::move(grid)), block(block),
+          block_rows((this->grid->rows + block - 1) / block), block_cols((this->grid->cols + block - 1) / block) {}
 
-    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
-        auto maze_state = std::dynamic_pointer_cast<MazeState>(state);
-        std::vector<std::shared_ptr<Action>> actions;
+    std::size_t size() const { return static_cast<std::size_t>(block_rows) * block_cols; }
 
-        auto create_state = [&](int x, int y) {
-            return std::make_shared<MazeState>(maze_state->maze, x, y);
-        };
+    std::size_t rank(const MazeState &state) const { return static_cast<std::size_t>(state.x / block) * block_cols + state.y / block; }
+
+    void goals(std::vector<std::size_t> &out) const { out.push_back(rank(MazeState(grid->goal_x, grid->goal_y))); }
 
-        // Add possible actions with smart pointers
-        if (maze_state->x > 0 && maze_state->maze[maze_state->x - 1][maze_state->y] != 1) {
-            actions.push_back(std::make_shared<Action>("Up", 1, state, create_state(maze_state->x - 1, maze_state->y)));
+    // Moves are reversible, so the predecessors of a block are the neighbouring blocks a move crosses into
+    void predecessors(std::size_t rank, std::vector<std::size_t> &out) const {
+        int bx = static_cast<int>(rank / block_cols);
+        int by = static_cast<int>(rank % block_cols);
+        if (bx > 0 && crosses_rows(bx * block - 1, by)) {
+            out.push_back(rank - block_cols);
         }
-        if (maze_state->x < maze_state->maze.size() - 1 && maze_state->maze[maze_state->x + 1][maze_state->y] != 1) {
-            actions.push_back(std::make_shared<Action>("Down", 1, state, create_state(maze_state->x + 1, maze_state->y)));
+        if (bx + 1 < block_rows && crosses_rows((bx + 1) * block - 1, by)) {
+            out.push_back(rank + block_cols);
         }
-        if (maze_state->y > 0 && maze_state->maze[maze_state->x][maze_state->y - 1] != 1) {
-            actions.push_back(std::make_shared<Action>("Left", 1, state, create_state(maze_state->x, maze_state->y - 1)));
+        if (by > 0 && crosses_cols(bx, by * block - 1)) {
+            out.push_back(rank - 1);
         }
-        if (maze_state->y < maze_state->maze[0].size() - 1 && maze_state->maze[maze_state->x][maze_state->y + 1] != 1) {
-            actions.push_back(std::make_shared<Action>("Right", 1, state, create_state(maze_state->x, maze_state->y + 1)));
+        if (by + 1 < block_cols && crosses_cols(bx, (by + 1) * block - 1)) {
+            out.push_back(rank + 1);
         }
-
-        return actions;
     }
 
+    std::shared_ptr<const MazeGrid> grid;
+    int block;
+    int block_rows;
+    int block_cols;
 
+private:
+    // Whether some move crosses between rows x and x + 1 within block column by
+    bool crosses_rows(int x, int by) const {
+        for (int y = by * block; y < std::min((by + 1) * block, grid->cols); y++) {
+            if (grid->passable(x, y) && grid->passable(x + 1, y)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-    double heuristic(State *state) override {
-        auto *maze_state = dynamic_cast<MazeState *>(state);
-        return abs(maze_state->x - 3) + abs(maze_state->y - 3);
+    // Whether some move crosses between columns y and y + 1 within block row bx
+    bool crosses_cols(int bx, int y) const {
+        for (int x = bx * block; x < std::min((bx + 1) * block, grid->rows); x++) {
+            if (grid->passable(x, y) && grid->passable(x, y + 1)) {
+                return true;
+            }
+        }
+        return false;
     }
 };
 
@@ -5,10 +5,18 @@
 #ifndef STUDY_PATH_H
 #define STUDY_PATH_H
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include "symphony.h"
@@ -16,74 +24,208 @@
 
 
 // Study-specific classes
-class StudyState : public State {
+
+/**
+ * @brief Topic names of a study plan, interned to dense indices.
+ *
+ * Topics are numbered in sorted name order, the order of the JSON object they come from, so states and the problem's tables
+ * refer to them by index and never compare strings while searching.
+ */
+class StudyTopics {
 public:
-    std::map<std::string, double> mastery_levels; // Topic -> Mastery %
+    /// Largest number of topics; states store one mastery entry per possible topic.
+    static constexpr std::size_t MAX = 64;
+
+    /**
+     * @param names Sorted, distinct topic names.
+     * @throws std::invalid_argument if there are more than MAX topics.
+     */
+    explicit StudyTopics(std::vector<std::string> names) : names(std::move(names)) {
+        if (this->names.size() > MAX) {
+            throw std::invalid_argument("A study plan has at most " + std::to_string(MAX) + " topics");
+        }
+    }
+
+    std::size_t size() const { return names.size(); }
+
+    const std::string& name(std::size_t topic) const { return names[topic]; }
+
+    /// Index of a topic, or size() if there is no such topic.
+    std::size_t find(const std::string& name) const {
+        auto found = std::lower_bound(names.begin(), names.end(), name);
+        return found != names.end() && *found == name ? static_cast<std::size_t>(found - names.begin()) : names.size();
+    }
+
+private:
+    std::vector<std::string> names;
+};
+
+class StudyState final : public State {
+public:
+    /// Mastery is stored in fixed point, in hundredths of a percent.
+    static constexpr int SCALE = 100;
+    using Mastery = std::array<std::uint16_t, StudyTopics::MAX>;
+
+    Mastery mastery{};              // Mastery of topic i in hundredths of a percent; entries past the last topic stay 0
     double remaining_time;
+    const StudyTopics* topics;      // Names of the topics, shared by every state of a plan
+    std::shared_ptr<const StudyTopics> table; // Keeps the names alive; only set on states built from names
+
+    /**
+     * @brief Interns the topics of a plan and stores their mastery.
+     *
+     * @param mastery_levels Topic -> mastery %, rounded to hundredths.
+     * @param remaining_time Hours left.
+     * @throws std::invalid_argument if there are more than StudyTopics::MAX topics.
+     */
+    StudyState(const std::map<std::string, double>& mastery_levels, double remaining_time)
+        : remaining_time(remaining_time), table(std::make_shared<const StudyTopics>(topic_names(mastery_levels))) {
+        topics = table.get();
+        std::size_t topic = 0;
+        for (const auto& [_, level] : mastery_levels) {
+            mastery[topic++] = to_fixed(level);
+        }
+    }
 
-    StudyState(std::map<std::string, double> mastery_levels, double remaining_time)
-        : mastery_levels(std::move(mastery_levels)), remaining_time(remaining_time) {}
+    /// A state of an existing plan; topics must outlive it.
+    StudyState(const StudyTopics* topics, const Mastery& mastery, double remaining_time)
+        : mastery(mastery), remaining_time(remaining_time), topics(topics) {}
+
+    /// Converts a percentage to fixed point, saturating at the largest representable value.
+    static std::uint16_t to_fixed(double percent) {
+        return static_cast<std::uint16_t>(std::clamp(std::lround(percent * SCALE), 0L, 0xffffL));
+    }
+
+    /// Mastery % of a topic.
+    double mastery_of(std::size_t topic) const { return static_cast<double>(mastery[topic]) / SCALE; }
+
+    std::size_t topic_count() const { return topics->size(); }
 
     void print() override {
-        for (const auto& [topic, mastery] : mastery_levels) {
-            std::cout << topic << ": " << mastery << "%\n";
+        for (std::size_t topic = 0; topic < topic_count(); topic++) {
+            std::cout << topics->name(topic) << ": " << mastery_of(topic) << "%\n";
         }
         std::cout << "Time left: " << remaining_time << " hours\n";
     }
+
+    std::size_t hash() const override {
+        std::size_t seed = std::hash<double>{}(remaining_time);
+        // Four entries per word; unused entries are 0, so whole words can be hashed
+        std::size_t words = (topic_count() + 3) / 4;
+        for (std::size_t i = 0; i < words; i++) {
+            std::uint64_t word;
+            std::memcpy(&word, mastery.data() + 4 * i, sizeof(word));
+            seed = hash_combine(seed, word);
+        }
+        return seed;
+    }
+
+    bool operator==(const StudyState& other) const {
+        return remaining_time == other.remaining_time && mastery == other.mastery;
+    }
+
+    bool equals(const State& other) const override {
+        auto* study_state = dynamic_cast<const StudyState*>(&other);
+        return study_state && *study_state == *this;
+    }
+
+private:
+    static std::vector<std::string> topic_names(const std::map<std::string, double>& mastery_levels) {
+        std::vector<std::string> names;
+        for (const auto& [topic, _] : mastery_levels) {
+            names.push_back(topic);
+        }
+        return names;
+    }
 };
 
-class StudyProblem : public Problem {
-    StudyState* initial_state_;
-    std::map<std::string, std::vector<std::string>> dependencies; // Topic -> Prerequisites
-    std::map<std::string, double> synergies; // Topic synergy weights
+/**
+ * @brief Plans study sessions until every topic is mastered.
+ *
+ * Topics are referred to by their index in the initial state's StudyTopics. Synergies become a signed fixed-point bonus per topic,
+ * so a negative synergy slows a topic down, and dependencies a bitmask of prerequisite topics per topic; names in either map
+ * that are not topics of the plan are ignored. Mastery after a session is clamped to the 0% to 655.35% a state can hold.
+ * Prerequisites are recorded but, as before, not enforced by the search.
+ */
+class StudyProblem : public TypedProblem<StudyProblem, StudyState> {
+    std::shared_ptr<const StudyTopics> table;     // Keeps the initial state's topic names alive
+    const StudyTopics* topics;
+    std::vector<std::uint64_t> prerequisite_masks; // Topic -> bit i set if topic i is a prerequisite
+    std::vector<std::int32_t> synergy_bonus;       // Topic -> fixed-point mastery added on top of every session; negative bonuses slow it down
 
 public:
     StudyProblem(StudyState* initial_state,
-                 std::map<std::string, std::vector<std::string>> dependencies,
-                 std::map<std::string, double> synergies)
-        : initial_state_(initial_state), dependencies(std::move(dependencies)), synergies(std::move(synergies)) {}
-
-    State* initial_state() override {
-        return initial_state_;
+                 const std::map<std::string, std::vector<std::string>>& dependencies,
+                 const std::map<std::string, double>& synergies)
+        : table(initial_state->table), topics(initial_state->topics),
+          prerequisite_masks(topics->size(), 0), synergy_bonus(topics->size(), 0) {
+        initial_state_ = initial_state;
+        // The i-th topic gets action id i
+        for (std::size_t topic = 0; topic < topics->size(); topic++) {
+            action_table.intern(topics->name(topic));
+        }
+        for (const auto& [topic, prerequisites] : dependencies) {
+            std::size_t index = topics->find(topic);
+            for (const auto& prerequisite : prerequisites) {
+                std::size_t required = topics->find(prerequisite);
+                if (index < topics->size() && required < topics->size()) {
+                    prerequisite_masks[index] |= std::uint64_t(1) << required;
+                }
+            }
+        }
+        for (const auto& [topic, bonus] : synergies) {
+            std::size_t index = topics->find(topic);
+            if (index < topics->size()) {
+                synergy_bonus[index] = static_cast<std::int32_t>(std::lround(bonus * StudyState::SCALE));
+            }
+        }
     }
 
-    bool goal_test(State* state) override {
-        auto* study_state = dynamic_cast<StudyState*>(state);
-        for (const auto& [_, mastery] : study_state->mastery_levels) {
-            if (mastery < 100.0) return false;
+    bool is_goal(const StudyState& state) const {
+        for (std::size_t topic = 0; topic < topics->size(); topic++) {
+            if (state.mastery[topic] < 100 * StudyState::SCALE) return false;
         }
         return true;
     }
 
-    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
-        auto* study_state = std::dynamic_pointer_cast<StudyState>(state).get();
-        std::vector<std::shared_ptr<Action>> available_actions;
-
-        for (const auto& [topic, mastery] : study_state->mastery_levels) {
-            if (mastery < 100.0 && study_state->remaining_time > 0) {
+    void expand(const StudyState& state, SuccessorBuffer<StudyState>& out) const {
+        if (state.remaining_time <= 0) {
+            return;
+        }
+        constexpr int FULL = 100 * StudyState::SCALE;
+        for (std::size_t topic = 0; topic < topics->size(); topic++) {
+            int mastery = state.mastery[topic];
+            if (mastery < FULL) {
                 double cost = 1.0; // 1 hour per study session
-                auto new_mastery = study_state->mastery_levels;
-                new_mastery[topic] += std::min(10.0, 100.0 - mastery); // Increment by 10%, cap at 100%
-                double synergy_bonus = synergies.count(topic) ? synergies.at(topic) : 0.0;
-                new_mastery[topic] += synergy_bonus;
-
-                double time_left = study_state->remaining_time - cost;
-                auto new_state = new StudyState(new_mastery, time_left);
-                available_actions.emplace_back( std::make_shared<Action>(topic, cost, state, std::shared_ptr<State>(new_state)) );
+                // Increment by 10%, capped at 100%, then add the topic's synergy bonus; only the result is clamped to what a state stores
+                std::int64_t gain = std::min(10 * StudyState::SCALE, FULL - mastery) + std::int64_t(synergy_bonus[topic]);
+                out.emplace(static_cast<ActionId>(topic), cost, topics, state.mastery, state.remaining_time - cost);
+                out[out.size() - 1].state.mastery[topic] = static_cast<std::uint16_t>(std::clamp<std::int64_t>(mastery + gain, 0, 0xffff));
             }
         }
+    }
 
-        return available_actions;
+    const std::string& action_name(ActionId action) const override {
+        return action_table.name(action);
     }
 
-    double heuristic(State* state) override {
-        auto* study_state = dynamic_cast<StudyState*>(state);
-        double total_gap = 0;
-        for (const auto& [_, mastery] : study_state->mastery_levels) {
-            total_gap += (100.0 - mastery);
+    double h(const StudyState& state) const {
+        // Gaps are negative for topics pushed past 100% by synergies, as before
+        std::int64_t total_gap = 0;
+        for (std::size_t topic = 0; topic < topics->size(); topic++) {
+            total_gap += 100 * StudyState::SCALE - state.mastery[topic];
         }
-        return total_gap / study_state->remaining_time;
+        return static_cast<double>(total_gap) / StudyState::SCALE / state.remaining_time;
     }
+
+    /// Bitmask of the prerequisites of a topic.
+    std::uint64_t prerequisites(std::size_t topic) const { return prerequisite_masks[topic]; }
+
+    /// Mastery % a session on a topic adds beyond the usual 10%.
+    double synergy(std::size_t topic) const { return static_cast<double>(synergy_bonus[topic]) / StudyState::SCALE; }
+
+    /// The interned topic names.
+    const StudyTopics& topic_table() const { return *topics; }
 };
 
 // Main Function
@@ -1,9 +1,12 @@
 #ifndef TASK_SCHEDULER_H
 #define TASK_SCHEDULER_H
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <iostream>
 #include <vector>
-#include <queue>
 #include "../symphony.h"
 
 
@@ -27,73 +30,164 @@ public:
 
 /**
  * @brief Represents the state of the task scheduler problem.
+ *
+ * Tasks are defined once by the problem and numbered by their position there; the state only records which are still to do.
+ * Bit i of remaining is set while task i is, and tasks from 64 on use one more word of overflow per 64 tasks,
+ * so instances with at most 64 tasks copy a single word per successor.
  */
-class TaskSchedulerState : public State {
+class TaskSchedulerState final : public State {
 public:
-    TaskSchedulerState() {
-        tasks = {
-            Task("Task 1", 3, 5),
-            Task("Task 2", 2, 3),
-            Task("Task 3", 5, 10)
-        };
+    TaskSchedulerState(const std::vector<Task> *tasks, std::uint64_t remaining, std::vector<std::uint64_t> overflow = {})
+        : remaining(remaining), overflow(std::move(overflow)), tasks(tasks) {}
+
+    /// The state with every task still to do.
+    static TaskSchedulerState all(const std::vector<Task> *tasks) {
+        std::size_t count = tasks->size();
+        std::uint64_t first = count >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+        std::vector<std::uint64_t> overflow;
+        for (std::size_t done = 64; done < count; done += 64) {
+            overflow.push_back(count - done >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << (count - done)) - 1);
+        }
+        return TaskSchedulerState(tasks, first, std::move(overflow));
+    }
+
+    std::uint64_t remaining;
+    std::vector<std::uint64_t> overflow;
+    const std::vector<Task> *tasks;  // Definitions of the tasks, owned by the problem
+
+    /// Words of the mask; word 0 is remaining.
+    std::size_t words() const { return 1 + overflow.size(); }
+
+    std::uint64_t word(std::size_t i) const { return i == 0 ? remaining : overflow[i - 1]; }
+
+    bool pending(std::size_t task) const { return word(task / 64) >> (task % 64) & 1; }
+
+    void complete(std::size_t task) {
+        std::uint64_t bit = std::uint64_t(1) << (task % 64);
+        (task < 64 ? remaining : overflow[task / 64 - 1]) &= ~bit;
     }
-    TaskSchedulerState(const TaskSchedulerState &other) {
-        tasks = other.tasks;
+
+    bool done() const {
+        return remaining == 0 && std::all_of(overflow.begin(), overflow.end(), [](std::uint64_t bits) { return bits == 0; });
     }
-    TaskSchedulerState(std::vector<Task> tasks) : tasks(tasks) {}
-    std::vector<Task> tasks;
+
+    std::size_t pending_count() const {
+        std::size_t count = std::popcount(remaining);
+        for (std::uint64_t bits : overflow) {
+            count += std::popcount(bits);
+        }
+        return count;
+    }
+
     void print() override {
-        for (const auto &task : tasks) {
-            std::cout << "Task: " << task.name << ", Priority: " << task.priority << ", Deadline: " << task.deadline << std::endl;
+        for (std::size_t i = 0; i < tasks->size(); i++) {
+            if (pending(i)) {
+                const Task &task = (*tasks)[i];
+                std::cout << "Task: " << task.name << ", Priority: " << task.priority << ", Deadline: " << task.deadline << std::endl;
+            }
         }
     }
+    std::size_t hash() const override {
+        std::size_t seed = std::hash<std::uint64_t>{}(remaining);
+        for (std::uint64_t bits : overflow) {
+            seed = hash_combine(seed, std::hash<std::uint64_t>{}(bits));
+        }
+        return seed;
+    }
+    bool operator==(const TaskSchedulerState &other) const {
+        return remaining == other.remaining && overflow == other.overflow;
+    }
+    bool equals(const State &other) const override {
+        auto *scheduler_state = dynamic_cast<const TaskSchedulerState *>(&other);
+        return scheduler_state && *scheduler_state == *this;
+    }
+    bool pack(std::uint64_t &key) const override {
+        // The all-ones key is reserved, so only instances with fewer than 64 tasks pack
+        if (tasks->size() >= 64) {
+            return false;
+        }
+        key = remaining;
+        return true;
+    }
 };
 
 
-class TaskScheduler : public Problem {
+class TaskScheduler : public TypedProblem<TaskScheduler, TaskSchedulerState> {
 /**
  * @brief Represents the task scheduler problem.
  * This class defines the initial state, goal test, actions, and heuristics for the task scheduler problem.
  * The problem is to complete a set of tasks with different priorities and deadlines. The goal is to complete all tasks.
  */
 public:
-    TaskScheduler() {
-        initial_state_ = new TaskSchedulerState();
+    TaskScheduler() : TaskScheduler({Task("Task 1", 3, 5), Task("Task 2", 2, 3), Task("Task 3", 5, 10)}) {}
+
+    /**
+     * @brief Creates an instance with the given tasks to complete.
+     *
+     * @param tasks The tasks; names must be unique. Any number of tasks is supported.
+     */
+    explicit TaskScheduler(std::vector<Task> tasks) : tasks(std::move(tasks)) {
+        initial_state_ = new TaskSchedulerState(TaskSchedulerState::all(&this->tasks));
+        // Task i gets the interned "Complete <task>" action complete_actions[i]
+        for (const auto &task : this->tasks) {
+            complete_actions.push_back(action_table.intern("Complete " + task.name));
+        }
+        // priority_sums[b][m]: total priority of the tasks 8b to 8b+7 whose bits are set in m
+        priority_sums.resize((this->tasks.size() + 7) / 8);
+        for (std::size_t byte = 0; byte < priority_sums.size(); byte++) {
+            for (unsigned mask = 0; mask < 256; mask++) {
+                int total = 0;
+                for (unsigned bit = 0; bit < 8 && 8 * byte + bit < this->tasks.size(); bit++) {
+                    if (mask >> bit & 1) {
+                        total += this->tasks[8 * byte + bit].priority;
+                    }
+                }
+                priority_sums[byte][mask] = total;
+            }
+        }
     }
     ~TaskScheduler() {
     }
-    bool goal_test(State *state) override {
-        auto *scheduler_state = dynamic_cast<TaskSchedulerState *>(state);
-        return scheduler_state && scheduler_state->tasks.empty();
-    }
-    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
-        auto scheduler_state = std::dynamic_pointer_cast<TaskSchedulerState>(state);
-        std::vector<std::shared_ptr<Action>> actions;
-
-        for (const auto &task : scheduler_state->tasks) {
-            auto new_state = std::make_shared<TaskSchedulerState>(*scheduler_state);
-            // Remove the task from the new state
-            int index = 0;
-            for (const auto &t : new_state->tasks) {
-                if (t == task) {
-                    new_state->tasks.erase(new_state->tasks.begin() + index);
-                    break;
-                }
-                index++;
+    bool is_goal(const TaskSchedulerState &state) const {
+        return state.done();
+    }
+    void expand(const TaskSchedulerState &state, SuccessorBuffer<TaskSchedulerState> &out) const {
+        for (std::size_t w = 0; w < state.words(); w++) {
+            for (std::uint64_t bits = state.word(w); bits != 0; bits &= bits - 1) {
+                // The successor keeps every task except the completed one
+                std::size_t task = 64 * w + std::countr_zero(bits);
+                out.emplace(complete_actions[task], 1, state);
+                out[out.size() - 1].state.complete(task);
             }
-            actions.push_back(std::make_shared<Action>("Complete " + task.name, 1, state, new_state));
         }
-
-        return actions;
     }
-    double heuristic(State *state) override {
-        auto *scheduler_state = dynamic_cast<TaskSchedulerState *>(state);
+    const std::string &action_name(ActionId action) const override {
+        return action_table.name(action);
+    }
+    bool integral_costs() const override {
+        return true;
+    }
+
+    /// Total priority of the remaining tasks, one table lookup per byte of the mask.
+    double h(const TaskSchedulerState &state) const {
         int total_priority = 0;
-        for (const auto &task : scheduler_state->tasks) {
-            total_priority += task.priority;
+        for (std::size_t byte = 0; byte < priority_sums.size(); byte++) {
+            total_priority += priority_sums[byte][state.word(byte / 8) >> (8 * (byte % 8)) & 0xff];
         }
         return total_priority;
     }
+
+    bool pack(const TaskSchedulerState &state, std::uint64_t &key) const {
+        return state.pack(key);
+    }
+
+    /// The task definitions, indexed as the bits of the states.
+    const std::vector<Task> &task_list() const { return tasks; }
+
+private:
+    std::vector<Task> tasks;
+    std::vector<ActionId> complete_actions;
+    std::vector<std::array<int, 256>> priority_sums;
 };
 
-#endif
\ No newline at end of file
+#endif
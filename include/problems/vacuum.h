@@ -6,7 +6,11 @@
 #ifndef VACUUM_H
 #define VACUUM_H
 
+#include <bit>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include "../symphony.h"
 
 
@@ -14,16 +18,38 @@
 
 /**
  * @brief Represents the state of the vacuum cleaner problem.
+ *
+ * Rooms are numbered from 0 along a corridor; bit i of dirt is set while room i is dirty.
  */
-class VacuumState : public State {
+class VacuumState final : public State {
 public:
-    VacuumState() : x(0), dirty0(true), dirty1(true) {}
-    VacuumState(int x, bool dirty0, bool dirty1) : x(x), dirty0(dirty0), dirty1(dirty1) {}
+    /// Largest number of rooms pack() can encode: the room index takes the top 6 bits of the key and the dirt the other 58.
+    static constexpr int MAX_ROOMS = 58;
+
+    VacuumState() : x(0), dirt(0b11) {}
+    VacuumState(int x, std::uint64_t dirt) : x(x), dirt(dirt) {}
     int x;
-    bool dirty0;
-    bool dirty1;
+    std::uint64_t dirt;
+    bool dirty(int room) const { return room < 64 && (dirt >> room & 1); }
     void print() override {
-        std::cout << "VacuumState(" << x << ", " << dirty0 << ", " << dirty1 << ")" << std::endl;
+        std::cout << "VacuumState(" << x << ", dirty rooms " << std::hex << "0x" << dirt << std::dec << ")" << std::endl;
+    }
+    std::size_t hash() const override {
+        return hash_combine(std::hash<int>{}(x), std::hash<std::uint64_t>{}(dirt));
+    }
+    bool operator==(const VacuumState &other) const {
+        return x == other.x && dirt == other.dirt;
+    }
+    bool equals(const State &other) const override {
+        auto *vacuum_state = dynamic_cast<const VacuumState *>(&other);
+        return vacuum_state && *vacuum_state == *this;
+    }
+    bool pack(std::uint64_t &key) const override {
+        if (dirt >> MAX_ROOMS) {
+            return false;
+        }
+        key = std::uint64_t(x) << MAX_ROOMS | dirt;
+        return true;
     }
 };
 
@@ -31,63 +57,69 @@ public:
 /**
  * @brief Represents the vacuum cleaner problem.
  * This class defines the initial state, goal test, actions, and heuristics for the vacuum cleaner problem.
- * The problem is to clean two dirty rooms with a vacuum cleaner. The goal is to clean both rooms.
+ * The problem is to clean a row of dirty rooms with a vacuum cleaner that starts in the first one. The goal is to clean every room.
+ * The classic instance has two rooms.
  */
-class VacuumCleaner : public Problem {
+class VacuumCleaner : public TypedProblem<VacuumCleaner, VacuumState> {
 public:
-    VacuumCleaner() {
-        initial_state_ = new VacuumState();
+    enum Move : ActionId { SUCK, LEFT, RIGHT };
+
+    /**
+     * @param rooms Number of rooms, all dirty at the start.
+     * @throws std::invalid_argument unless there are between 1 and VacuumState::MAX_ROOMS rooms.
+     */
+    explicit VacuumCleaner(int rooms = 2) : rooms(rooms) {
+        if (rooms < 1 || rooms > VacuumState::MAX_ROOMS) {
+            throw std::invalid_argument("A vacuum corridor has between 1 and " + std::to_string(VacuumState::MAX_ROOMS) + " rooms");
+        }
+        initial_state_ = new VacuumState(0, (std::uint64_t(1) << rooms) - 1);
     }
     ~VacuumCleaner() {
     }
-    bool goal_test(State *state) override {
-        auto *vacuum_state = dynamic_cast<VacuumState *>(state);
-        /// nul.l check
-        if (vacuum_state == nullptr) {
-            return false;
-        }
-        return !vacuum_state->dirty0 && !vacuum_state->dirty1;
+    bool is_goal(const VacuumState &state) const {
+        return state.dirt == 0;
     }
     /**
-     * @brief Returns the possible actions for the given state.
+     * @brief Emits the possible actions for the given state: suck a dirty room, otherwise move to a neighbouring room.
      * @param state The current state.
-     * @return A vector of shared pointers to Action objects.
+     * @param out Receives the successors.
      */
-    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
-        auto vacuum_state = std::dynamic_pointer_cast<VacuumState>(state);
-        std::vector<std::shared_ptr<Action>> actions;
-
-        auto create_state = [&](int x, bool dirty0, bool dirty1) {
-            return std::make_shared<VacuumState>(x, dirty0, dirty1);
-        };
-
-        // Add possible actions with smart pointers
-        if (vacuum_state->x == 0) {
-            if (vacuum_state->dirty0) {
-                actions.push_back(std::make_shared<Action>("Suck", 1, state, create_state(0, false, vacuum_state->dirty1)));
-            } else {
-                actions.push_back(std::make_shared<Action>("Right", 1, state, create_state(1, vacuum_state->dirty0, vacuum_state->dirty1)));
-            }
-        } else {
-            if (vacuum_state->dirty1) {
-                actions.push_back(std::make_shared<Action>("Suck", 1, state, create_state(1, vacuum_state->dirty0, false)));
-            } else {
-                actions.push_back(std::make_shared<Action>("Left", 1, state, create_state(0, vacuum_state->dirty0, vacuum_state->dirty1)));
-            }
+    void expand(const VacuumState &state, SuccessorBuffer<VacuumState> &out) const {
+        if (state.dirty(state.x)) {
+            out.emplace(SUCK, 1, state.x, state.dirt & ~(std::uint64_t(1) << state.x));
+            return;
+        }
+        if (state.x > 0) {
+            out.emplace(LEFT, 1, state.x - 1, state.dirt);
         }
+        if (state.x + 1 < rooms) {
+            out.emplace(RIGHT, 1, state.x + 1, state.dirt);
+        }
+    }
 
-        return actions;
+    const std::string &action_name(ActionId action) const override {
+        static const std::string names[] = {"Suck", "Left", "Right"};
+        return names[action];
     }
 
     /**
      * @brief Returns the heuristic value for the given state.
      * @param state The current state.
-     * @return The heuristic value.
+     * @return The number of dirty rooms, each needing at least one Suck.
      */
-    double heuristic(State *state) override {
-        auto *vacuum_state = dynamic_cast<VacuumState *>(state);
-        return vacuum_state->dirty0 + vacuum_state->dirty1;
+    double h(const VacuumState &state) const {
+        return std::popcount(state.dirt);
     }
+
+    bool integral_costs() const override {
+        return true;
+    }
+
+    bool pack(const VacuumState &state, std::uint64_t &key) const {
+        return state.pack(key);
+    }
+
+    int rooms;
 };
 
 
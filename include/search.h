@@ -2,14 +2,23 @@
 #define SEARCH_H
 
 
+#include <functional>
+#include <future>
 #include <map>
 #include "definitions.h"
+#include "node_arena.h"
+#include "engine/batch.h"
+#include "engine/dstar_lite.h"
+#include "engine/frontier.h"
+#include "engine/heuristic_cache.h"
+#include "engine/virtual_problem.h"
 #include <memory>
 
 
 /* @brief Node class for search algorithms.
  *
- * This class represents a node in the search tree, which contains a state, a parent node, an action, the path cost to reach this node, and a heuristic value.
+ * This class represents a node on a solution path returned by a search, which contains a state, a parent node, an action, the path cost to reach this node, and a heuristic value.
+ * Search algorithms keep their working tree in a NodeArena and only build Node objects for the path they return.
  * The parent node is a shared pointer to prevent circular references and memory leaks.
  * The state is a smart pointer to manage memory and prevent memory leaks.
  * The action is a pointer to an immutable Action object.
@@ -38,10 +47,17 @@ public:
 };
 
 
+/* @brief Node record stored in the NodeArena of an engine running a VirtualProblem.
+ *
+ * Unlike Node, the parent is a 32-bit arena index, so building the search tree costs no reference counting and tearing it down is a single bulk release.
+ */
+using SearchNode = EngineNode<VirtualProblem::state_type>;
+
 /* @brief Abstract class for search algorithms.
  *
  * This class defines the structure of a search algorithm, which is used to explore a problem space and find a solution. The search algorithm is responsible for traversing the graph of states and actions to find a path from the initial state to a goal state.
  * All Symphony search algorithms should inherit from this class and implement the search method.
+ * The classes below are thin adapters: the algorithms themselves live in the templated engines under engine/, which they run on a VirtualProblem.
  * All methods must use smart pointers to manage memory and prevent memory leaks, they are all responsible for freeing the memory they allocate.
  */
 class Search {
@@ -50,6 +66,55 @@ public:
     virtual ~Search() {}
     virtual std::shared_ptr<Node> search() = 0;
     Problem *problem;
+    /* @brief Statistics of the last search() call: node counts, peaks, solution and timings.
+     */
+    SearchStats stats;
+    /* @brief Also time expansions, heuristic calls and frontier operations; costs a clock read around each of them.
+     */
+    bool phase_timers = false;
+    /* @brief Entries of a heuristic cache put in front of the problem by A*, IDA* and memory-bounded A*; 0 evaluates the heuristic every time.
+     *
+     * The cache lives for one search() call. Its hits and misses are reported in stats.
+     */
+    std::size_t heuristic_cache_entries = 0;
+    CacheEviction heuristic_cache_eviction = CacheEviction::CLOCK;
+    /* @brief Time, expansion and memory limits, cancellation and progress reports for search(); stats.status tells which one stopped it.
+     *
+     * Parallel breadth-first search checks them between layers, so it may overshoot a limit by up to one layer.
+     */
+    SearchLimits limits;
+
+    /* @brief Runs search() on another thread.
+     *
+     * Cancel it through a copy of limits.cancel. The search and its problem must outlive the returned future, and must not be used
+     * until it is ready.
+     */
+    std::future<std::shared_ptr<Node>> search_async();
+
+protected:
+    /* @brief Runs a templated engine, keeps its statistics and builds the solution path.
+     *
+     * @param engine An engine over a VirtualProblem wrapping this search's problem.
+     * @return The goal Node linked to its ancestors, or nullptr.
+     */
+    template <class Engine>
+    std::shared_ptr<Node> run(Engine &engine) {
+        engine.phase_timers = phase_timers;
+        engine.limits = limits;
+        NodeId goal = engine.search();
+        stats = engine.stats();
+        return materialize(engine.nodes(), goal);
+    }
+
+    /* @brief Builds the Node chain for the path ending at the goal.
+     *
+     * Walks the parent indices once and materializes only the solution path, including its Action objects.
+     *
+     * @param nodes The arena of the engine that ran the search.
+     * @param goal The goal node, or NO_NODE if the search failed.
+     * @return The goal Node linked to its ancestors, or nullptr.
+     */
+    std::shared_ptr<Node> materialize(const NodeArena<SearchNode> &nodes, NodeId goal);
 };
 
 class Solution {
@@ -66,20 +131,49 @@ public:
  */
 class BreadthFirstSearch : public Search {
 public:
-    BreadthFirstSearch(Problem *problem) : Search(problem) {}
+    /**
+     * @param problem The problem to solve.
+     * @param eliminate_duplicates Skip children whose state was already generated. Memory then grows with the number of distinct states instead of the number of paths.
+     * @param threads Threads expanding each layer; 1 runs the serial search and 0 uses the hardware concurrency.
+     *                The parallel search returns the same solution as the serial one, but the problem must be safe to use from several threads.
+     */
+    BreadthFirstSearch(Problem *problem, bool eliminate_duplicates = true, unsigned threads = 1)
+        : Search(problem), eliminate_duplicates(eliminate_duplicates), threads(threads) {}
     /**
     * @brief Breadth-first search algorithm implementation.
     * The breadth-first search algorithm explores a graph by visiting all the neighbor nodes at the present depth prior to moving on to the nodes at the next depth level.
+    * Duplicates are detected when a child is generated, so each state enters the frontier at most once.
     */
     std::shared_ptr<Node> search() override;
     ~BreadthFirstSearch();
+    bool eliminate_duplicates;
+    unsigned threads;
 };
 
 class AStarSearch : public Search {
 public:
-    AStarSearch(Problem *problem) : Search(problem) {}
+    /**
+     * @param problem The problem to solve.
+     * @param frontier The priority queue to use. AUTO picks a bucket queue when the problem declares integral costs.
+     */
+    AStarSearch(Problem *problem, FrontierKind frontier = FrontierKind::AUTO) : Search(problem), frontier(frontier) {}
     std::shared_ptr<Node> search() override;
     ~AStarSearch();
+    FrontierKind frontier;
+};
+
+/**
+ * @brief Uniform-cost search algorithm implementation.
+ *
+ * Dijkstra-style search that always expands the cheapest path found so far, ignoring the heuristic.
+ * Returns an optimal solution for non-negative action costs and uses the same frontiers as A*.
+ */
+class UniformCostSearch : public Search {
+public:
+    UniformCostSearch(Problem *problem, FrontierKind frontier = FrontierKind::AUTO) : Search(problem), frontier(frontier) {}
+    std::shared_ptr<Node> search() override;
+    ~UniformCostSearch() override;
+    FrontierKind frontier;
 };
 
 /* @brief Beam search algorithm implementation.
@@ -88,7 +182,14 @@ public:
  */
 class BeamSearch : public Search {
 public:
-    BeamSearch(Problem *problem, int beam_width) : Search(problem), beam_width(beam_width) {}
+    /**
+     * @param problem The problem to solve.
+     * @param beam_width Number of nodes kept per layer.
+     * @param deduplicate Merge children of a layer that reach the same state, keeping the cheaper one.
+     * @param bounded_layer Keep only the beam_width best children while a layer is generated instead of collecting the whole layer first.
+     */
+    BeamSearch(Problem *problem, int beam_width, bool deduplicate = false, bool bounded_layer = false)
+        : Search(problem), beam_width(beam_width), deduplicate(deduplicate), bounded_layer(bounded_layer) {}
     /* @brief Beam search algorithm implementation.
      *
      * This class implements the beam search algorithm, which is a heuristic search algorithm that explores a graph by expanding the most promising nodes in the search tree.
@@ -97,13 +198,203 @@ public:
     std::shared_ptr<Node> search() override;
     ~BeamSearch() override;
     int beam_width;
+    bool deduplicate;
+    bool bounded_layer;
+};
+
+/**
+ * @brief Hash-distributed parallel A* (HDA*).
+ *
+ * Splits the states among worker threads by hash; each worker runs A* on the states it owns and sends the others their successors.
+ * Returns an optimal solution like AStarSearch. The problem must be safe to expand and evaluate from several threads at once.
+ */
+class ParallelAStarSearch : public Search {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param threads Number of worker threads; 0 uses the hardware concurrency.
+     * @param frontier The priority queue each worker uses.
+     */
+    ParallelAStarSearch(Problem *problem, unsigned threads = 0, FrontierKind frontier = FrontierKind::AUTO)
+        : Search(problem), threads(threads), frontier(frontier) {}
+    std::shared_ptr<Node> search() override;
+    ~ParallelAStarSearch() override;
+    unsigned threads;
+    FrontierKind frontier;
+};
+
+/**
+ * @brief Bidirectional A* search.
+ *
+ * Searches forward from the initial state and backward from Problem::goal_state() over Problem::predecessors() at the same time,
+ * and splices the two halves where they meet. Returns an optimal solution for consistent heuristics.
+ * Backward estimates come from Problem::reverse_heuristic().
+ */
+class BidirectionalSearch : public Search {
+public:
+    /**
+     * @param problem The problem to solve. It must provide goal_state() and predecessors().
+     * @param use_heuristic Guide both directions with their heuristics; false runs bidirectional uniform-cost search.
+     * @param frontier The priority queue each direction uses.
+     */
+    BidirectionalSearch(Problem *problem, bool use_heuristic = true, FrontierKind frontier = FrontierKind::AUTO)
+        : Search(problem), use_heuristic(use_heuristic), frontier(frontier) {}
+    /**
+     * @throws std::logic_error if the problem has no goal state or no predecessors.
+     */
+    std::shared_ptr<Node> search() override;
+    ~BidirectionalSearch() override;
+    bool use_heuristic;
+    FrontierKind frontier;
+};
+
+/**
+ * @brief Iterative-deepening A* (IDA*) search.
+ *
+ * Optimal like A*, but memory grows only with the solution depth: repeated depth-first searches with a rising f-bound replace the open list.
+ * Trades memory for time, as states are re-expanded in every iteration.
+ */
+class IDAStarSearch : public Search {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param transposition_entries Entries in a fixed-size transposition table that prunes repeated states within an iteration; 0 disables it.
+     */
+    IDAStarSearch(Problem *problem, std::size_t transposition_entries = 0)
+        : Search(problem), transposition_entries(transposition_entries) {}
+    std::shared_ptr<Node> search() override;
+    ~IDAStarSearch() override;
+    std::size_t transposition_entries;
+};
+
+/**
+ * @brief Memory-bounded A* (SMA*) search.
+ *
+ * Behaves like A* until the byte budget is reached, then drops the least promising leaves and regenerates them later if needed.
+ * Returns an optimal solution whenever the optimal path fits in the budget; best_effort tells whether the last search had to cut off
+ * paths that might have been better.
+ */
+class MemoryBoundedAStarSearch : public Search {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param memory_budget Bytes of nodes and frontier the search may hold.
+     * @param expansion_limit Expansions after which the search gives up; 0 means no limit.
+     */
+    MemoryBoundedAStarSearch(Problem *problem, std::size_t memory_budget, std::size_t expansion_limit = 0)
+        : Search(problem), memory_budget(memory_budget), expansion_limit(expansion_limit) {}
+    std::shared_ptr<Node> search() override;
+    ~MemoryBoundedAStarSearch() override;
+    std::size_t memory_budget;
+    std::size_t expansion_limit;
+    /// Set by search(): true if the budget forced cutting off paths, so the result is not guaranteed optimal (or a solution may exist beyond the budget).
+    bool best_effort = false;
+};
+
+/**
+ * @brief Anytime repairing A* (ARA*).
+ *
+ * Finds a first solution quickly by inflating the heuristic, then keeps lowering the inflation and repairing the search it already did,
+ * so the solution improves for as long as the search runs. Stops with an optimal solution, or earlier at one of its limits
+ * with the best one so far. Each solution costs at most suboptimality_bound times the optimum, for a consistent heuristic.
+ */
+class AnytimeAStarSearch : public Search {
+public:
+    /**
+     * @param problem The problem to solve.
+     * @param initial_weight Heuristic weight of the first iteration; 1 runs plain A*.
+     * @param weight_step Amount the weight drops after each iteration, down to 1.
+     */
+    AnytimeAStarSearch(Problem *problem, double initial_weight = 2.5, double weight_step = 0.5)
+        : Search(problem), initial_weight(initial_weight), weight_step(weight_step) {}
+    std::shared_ptr<Node> search() override;
+    ~AnytimeAStarSearch() override;
+    double initial_weight;
+    double weight_step;
+    /// Called during search() with every improving solution and its suboptimality bound.
+    std::function<void(std::shared_ptr<Node> solution, double bound)> on_solution;
+    /// Set by search(): the suboptimality bound of the returned solution, 1 when it is proven optimal.
+    double suboptimality_bound = 0.0;
+    /// Set by search(): true if a limit stopped the search before it proved its solution optimal.
+    bool interrupted = false;
+};
+
+/**
+ * @brief Incremental replanning with D* Lite.
+ *
+ * Keeps its goal distances between search() calls. After changing the problem, report every state whose actions changed with
+ * changed(); the next search() repairs only the distances those changes affect. The initial state may also move between searches.
+ * Optimal like A*; the problem must provide goal_state() and predecessors(), and reverse_heuristic() must be consistent.
+ */
+class DStarLiteSearch : public Search {
+public:
+    DStarLiteSearch(Problem *problem) : Search(problem), adapter(problem), engine(adapter) {}
+    /**
+     * @throws std::logic_error if the problem has no goal state.
+     */
+    std::shared_ptr<Node> search() override;
+    ~DStarLiteSearch() override;
+    /// Marks a state whose incoming or outgoing actions changed since the last search, with its predecessors and successors.
+    void changed(std::shared_ptr<State> state);
+    /// Forgets the kept distances, so the next search starts from scratch.
+    void reset();
+
+private:
+    VirtualProblem adapter;
+    DStarLite<VirtualProblem> engine;
 };
 
 enum SearchAlgorithmIndex {
     BREADTH_FIRST_SEARCH,
     UNIFORM_COST_SEARCH,
     A_STAR,
-    BEAM_SEARCH
+    BEAM_SEARCH,
+    PARALLEL_A_STAR,
+    BIDIRECTIONAL_SEARCH,
+    IDA_STAR,
+    MEMORY_BOUNDED_A_STAR,
+    ANYTIME_A_STAR,
+    D_STAR_LITE
+};
+
+/**
+ * @brief Tuning options passed to create_search().
+ */
+struct SearchConfig {
+    /// Priority queue used by the best-first algorithms.
+    FrontierKind frontier = FrontierKind::AUTO;
+    /// Nodes kept per layer by beam search.
+    int beam_width = 2;
+    /// Merge duplicate states within a beam search layer.
+    bool beam_deduplicate = false;
+    /// Bound each beam search layer to beam_width entries while it is generated.
+    bool beam_bounded_layer = false;
+    /// Worker threads used by parallel algorithms; 0 uses the hardware concurrency.
+    unsigned threads = 0;
+    /// Threads used by breadth-first search; 1 keeps it serial and 0 uses the hardware concurrency.
+    unsigned bfs_threads = 1;
+    /// Transposition table entries used by IDA*; 0 disables the table.
+    std::size_t ida_transposition_entries = 0;
+    /// Byte budget of memory-bounded A*.
+    std::size_t memory_budget = std::size_t(64) << 20;
+    /// Expansions after which memory-bounded A* gives up; 0 means no limit.
+    std::size_t memory_bounded_expansions = 0;
+    /// Heuristic weight of the first anytime A* iteration.
+    double anytime_initial_weight = 2.5;
+    /// Amount anytime A* lowers the weight after each iteration.
+    double anytime_weight_step = 0.5;
+    /// Seconds a search may run; 0 means no limit. Anytime A* returns its best solution so far when it runs out.
+    double time_limit = 0.0;
+    /// Expansions a search may make; 0 means no limit.
+    std::size_t node_limit = 0;
+    /// Bytes of nodes and frontier a search may hold, by its own estimate; 0 means no limit.
+    std::size_t memory_limit = 0;
+    /// Time expansions, heuristic calls and frontier operations in Search::stats.
+    bool phase_timers = false;
+    /// Heuristic values cached by A*, IDA* and memory-bounded A*; 0 disables the cache.
+    std::size_t heuristic_cache_entries = 0;
+    /// How a full heuristic cache makes room.
+    CacheEviction heuristic_cache_eviction = CacheEviction::CLOCK;
 };
 
 /**
@@ -111,8 +402,28 @@ enum SearchAlgorithmIndex {
  *
  * @param search_algorithm_index The index of the search algorithm to use.
  * @param problem The problem to solve.
+ * @param config Options for the created search.
  * @return A pointer to the created search object.
  */
-Search *create_search(SearchAlgorithmIndex search_algorithm_index, Problem *problem); // DEFINED IN search.cpp
+Search *create_search(SearchAlgorithmIndex search_algorithm_index, Problem *problem, const SearchConfig &config = SearchConfig()); // DEFINED IN search.cpp
+
+/**
+ * @brief Solves many problems with the same algorithm and options, concurrently, on a work-stealing thread pool.
+ *
+ * Instead of a Search per problem, each worker runs one engine and reuses it, with its node arena and tables, from problem to problem.
+ * The config's limits apply to each problem separately. Breadth-first search runs serially within each problem, and the heuristic
+ * cache options are ignored, since a cache keyed by state would mix up problems.
+ *
+ * @param problems The problems; they must not be changed or freed until the call returns.
+ * @param search_algorithm_index Any algorithm except PARALLEL_A_STAR and D_STAR_LITE.
+ * @param config Options of the searches.
+ * @param pool The threads to run on.
+ * @return Each problem's solution (nullptr if none) and statistics, in input order, and the totals of the batch.
+ * @throws std::invalid_argument for PARALLEL_A_STAR and D_STAR_LITE.
+ * @throws std::logic_error for BIDIRECTIONAL_SEARCH if a problem has no goal state.
+ */
+BatchReport<std::shared_ptr<Node>> solve_batch(std::span<Problem *const> problems, SearchAlgorithmIndex search_algorithm_index,
+                                               const SearchConfig &config = SearchConfig(),
+                                               WorkStealingPool &pool = WorkStealingPool::shared()); // DEFINED IN search.cpp
 
 #endif //SEARCH_H
@@ -0,0 +1,71 @@
+/**
+ * @file search_limits.h
+ * @brief Budgets, cancellation and progress reporting for a running search.
+ */
+
+#ifndef SEARCH_LIMITS_H
+#define SEARCH_LIMITS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Flag that asks a search to stop, shared by every copy of the token.
+ *
+ * Hand a copy to the search through SearchLimits and keep another to call cancel() from any thread.
+ * The search notices within one expansion and ends with SearchStatus::CANCELLED.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag->store(true, std::memory_order_relaxed); }
+
+    bool cancelled() const { return flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+/**
+ * @brief Snapshot of a running search, passed to SearchLimits::progress.
+ */
+struct SearchProgress {
+    std::uint64_t expanded;  ///< Expansions so far
+    double best_f;           ///< f of the node being expanded: the engine's current lower bound for A*-like engines
+    std::size_t memory;      ///< Estimated bytes of nodes and frontier held
+    double seconds;          ///< Time since the search started
+};
+
+/**
+ * @brief Limits a search checks as it runs; every zero or empty member means no limit.
+ *
+ * The cancellation token and the expansion limit are checked before every expansion. The clock and the memory estimate are read
+ * every CHECK_INTERVAL expansions, so a time or memory limit may be overshot by that much work.
+ * A search stopped by a limit returns normally, with the reason in SearchStats::status; engines that keep a best solution so far
+ * (anytime A*) still return it.
+ */
+struct SearchLimits {
+    /// Expansions between clock reads.
+    static constexpr std::uint64_t CHECK_INTERVAL = 64;
+
+    /// Wall-clock seconds the search may run.
+    double seconds = 0.0;
+    /// Expansions the search may make.
+    std::size_t expansions = 0;
+    /// Bytes of nodes and frontier entries the search may hold, by the engine's estimate.
+    std::size_t memory = 0;
+    /// Stops the search when cancelled.
+    CancellationToken cancel;
+    /// Called from the searching thread about every progress_seconds.
+    std::function<void(const SearchProgress &)> progress;
+    double progress_seconds = 0.1;
+
+    /// Whether anything has to be checked on the clock's cadence.
+    bool timed() const { return seconds > 0 || memory > 0 || progress; }
+};
+
+#endif // SEARCH_LIMITS_H
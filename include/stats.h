@@ -0,0 +1,144 @@
+/**
+ * @file stats.h
+ * @brief Counters and phase timers reported by every search engine.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Set SYMPHONY_STATS to 0 to compile the per-node counters and phase timers out of the engines.
+#ifndef SYMPHONY_STATS
+#define SYMPHONY_STATS 1
+#endif
+
+inline constexpr bool STATS_ENABLED = SYMPHONY_STATS != 0;
+
+/**
+ * @brief Why a search ended.
+ */
+enum class SearchStatus : std::uint8_t {
+    SOLVED,        ///< Found its solution
+    NO_SOLUTION,   ///< Explored everything it could without finding one
+    CANCELLED,     ///< The cancellation token in SearchLimits was set
+    TIME_LIMIT,    ///< Ran out of SearchLimits::seconds
+    NODE_LIMIT,    ///< Ran out of SearchLimits::expansions
+    MEMORY_LIMIT,  ///< Reached SearchLimits::memory
+};
+
+/// Lower-case name of a status, as written by SearchStats::to_json() and to_csv().
+const char *status_name(SearchStatus status);
+
+/**
+ * @brief What a search did, filled in by the engine that ran it.
+ *
+ * Counters are updated on the hot path through the inline `count_*` methods, which do nothing when statistics are compiled out.
+ * The search time, solution and peak sizes are recorded once per search and are always available.
+ * Phase timers only run when the engine's phase_timers flag is set, since they read the clock around every expansion, heuristic call
+ * and frontier operation; with several threads they add up the time of every thread.
+ */
+struct SearchStats {
+    std::uint64_t expanded = 0;         ///< Nodes whose successors were generated, counting re-expansions
+    std::uint64_t generated = 0;        ///< Successors produced by expansions
+    std::uint64_t duplicates = 0;       ///< Successors discarded because their state was already reached at no greater cost
+    std::uint64_t heuristic_calls = 0;  ///< Heuristic evaluations requested, including those answered by a heuristic cache
+    std::uint64_t heuristic_cache_hits = 0;    ///< Requests answered by a CachedHeuristic problem, if the engine runs on one
+    std::uint64_t heuristic_cache_misses = 0;  ///< Requests a CachedHeuristic problem had to evaluate
+    std::size_t peak_frontier = 0;      ///< Most entries held by the open list(s) at once
+    std::size_t peak_nodes = 0;         ///< Most search nodes held at once
+    std::size_t peak_memory = 0;        ///< Estimated bytes of nodes and frontier entries at the peak
+    bool solved = false;
+    SearchStatus status = SearchStatus::NO_SOLUTION;  ///< Why the search ended; a stopped anytime search may still be solved
+    double solution_cost = 0.0;
+    std::size_t solution_depth = 0;     ///< Actions on the solution path
+    double search_seconds = 0.0;        ///< Wall-clock time of the whole search
+    double expand_seconds = 0.0;        ///< Time spent generating successors
+    double heuristic_seconds = 0.0;     ///< Time spent evaluating the heuristic
+    double queue_seconds = 0.0;         ///< Time spent pushing to and popping from the frontier
+
+    void count_expansion(std::size_t children) {
+        if constexpr (STATS_ENABLED) {
+            expanded++;
+            generated += children;
+        }
+    }
+
+    void count_duplicate() {
+        if constexpr (STATS_ENABLED) {
+            duplicates++;
+        }
+    }
+
+    void count_heuristic(std::size_t calls = 1) {
+        if constexpr (STATS_ENABLED) {
+            heuristic_calls += calls;
+        }
+    }
+
+    void track_frontier(std::size_t size) {
+        if constexpr (STATS_ENABLED) {
+            if (size > peak_frontier) {
+                peak_frontier = size;
+            }
+        }
+    }
+
+    /**
+     * @brief Effective branching factor: the b for which a uniform tree of the solution's depth holds as many nodes as were generated.
+     *
+     * Solves 1 + b + b^2 + ... + b^d = generated + 1 by bisection. Returns 0 when there is no solution or nothing was generated.
+     */
+    double branching_factor() const;
+
+    /// Share of heuristic cache lookups that hit, or 0 without a cache.
+    double heuristic_cache_hit_rate() const {
+        std::uint64_t lookups = heuristic_cache_hits + heuristic_cache_misses;
+        return lookups ? static_cast<double>(heuristic_cache_hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    /// Adds up counters and times, and keeps the larger peaks; used to merge the statistics of parallel workers.
+    SearchStats &operator+=(const SearchStats &other);
+
+    /// One JSON object with every field and the effective branching factor.
+    std::string to_json() const;
+
+    /// Comma-separated field names, in the order of to_csv().
+    static std::string csv_header();
+
+    /// One comma-separated line of values, without a trailing newline.
+    std::string to_csv() const;
+};
+
+/**
+ * @brief Adds the time spent in a scope to a SearchStats field.
+ *
+ * Does not read the clock unless statistics are compiled in and the timer is enabled.
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(double &seconds, bool enabled) : seconds(seconds), enabled(STATS_ENABLED && enabled) {
+        if (this->enabled) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if (enabled) {
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    double &seconds;
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // STATS_H
@@ -7,6 +7,17 @@
 
 #include "definitions.h"
 #include "search.h"
+#include "engine/anytime_astar.h"
+#include "engine/batch.h"
+#include "engine/astar.h"
+#include "engine/beam.h"
+#include "engine/bidirectional.h"
+#include "engine/dstar_lite.h"
+#include "engine/idastar.h"
+#include "engine/memory_bounded.h"
+#include "engine/bfs.h"
+#include "engine/parallel_astar.h"
+#include "engine/parallel_bfs.h"
 #include "problems/vacuum.h"
 #include "problems/simple_maze.h"
 
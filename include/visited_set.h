@@ -0,0 +1,283 @@
+/**
+ * @file visited_set.h
+ * @brief Duplicate-detection structures used by the search algorithms.
+ */
+
+#ifndef VISITED_SET_H
+#define VISITED_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "engine/engine.h"
+
+/// splitmix64 finaliser: packed keys and raw hashes are often dense small integers, so they need scrambling before masking.
+inline std::uint64_t mix_bits(std::uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * @brief Open-addressing hash set of 64-bit packed state keys.
+ *
+ * Keys are stored inline in a single power-of-two array and probed linearly, so a membership test touches one or two cache lines
+ * and the set costs 8 bytes per slot instead of a heap node per entry.
+ * The all-ones key is reserved as the empty-slot marker and cannot be stored.
+ */
+class PackedKeySet {
+public:
+    static constexpr std::uint64_t EMPTY = ~std::uint64_t(0);
+
+    explicit PackedKeySet(std::size_t initial_capacity = 1024) {
+        std::size_t capacity = 16;
+        while (capacity < initial_capacity * 2) {
+            capacity <<= 1;
+        }
+        slots.assign(capacity, EMPTY);
+    }
+
+    /**
+     * @brief Inserts a key.
+     *
+     * @param key The packed state key.
+     * @return True if the key was not present before.
+     */
+    bool insert(std::uint64_t key) {
+        // Keep the load factor at or below one half so probe sequences stay short
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        if (place(slots, key)) {
+            count++;
+            return true;
+        }
+        return false;
+    }
+
+    bool contains(std::uint64_t key) const {
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = mix(key) & mask; slots[i] != EMPTY; i = (i + 1) & mask) {
+            if (slots[i] == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t size() const { return count; }
+
+    /// Bytes held by the slot array.
+    std::size_t memory_usage() const { return slots.size() * sizeof(std::uint64_t); }
+
+    void clear() {
+        std::fill(slots.begin(), slots.end(), EMPTY);
+        count = 0;
+    }
+
+private:
+    std::vector<std::uint64_t> slots;
+    std::size_t count = 0;
+
+    static std::size_t mix(std::uint64_t key) { return static_cast<std::size_t>(mix_bits(key)); }
+
+    static bool place(std::vector<std::uint64_t> &table, std::uint64_t key) {
+        std::size_t mask = table.size() - 1;
+        std::size_t i = mix(key) & mask;
+        while (table[i] != EMPTY) {
+            if (table[i] == key) {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        table[i] = key;
+        return true;
+    }
+
+    void grow() {
+        std::vector<std::uint64_t> larger(slots.size() * 2, EMPTY);
+        for (auto key : slots) {
+            if (key != EMPTY) {
+                place(larger, key);
+            }
+        }
+        slots.swap(larger);
+    }
+};
+
+/**
+ * @brief Set of visited states for duplicate elimination.
+ *
+ * Uses a PackedKeySet when the problem can pack its states into 64-bit keys (see PackableProblem),
+ * and falls back to a set of states keyed on the problem's hash and equality otherwise.
+ * The mode is chosen from the first state inserted; every state of a problem must then agree on whether it packs.
+ */
+template <SearchProblem P>
+class VisitedSet {
+public:
+    explicit VisitedSet(const P &problem)
+        : problem(problem), states(0, ProblemHash<P>{&problem}, ProblemEqual<P>{&problem}) {}
+
+    /**
+     * @brief Records a state as visited.
+     *
+     * @param state The state to record.
+     * @return True if the state had not been visited before.
+     */
+    bool insert(const typename P::state_type &state) {
+        if constexpr (PackableProblem<P>) {
+            std::uint64_t key = 0;
+            if (mode == Mode::UNDECIDED) {
+                mode = problem.pack(state, key) ? Mode::PACKED : Mode::STATES;
+                if (mode == Mode::PACKED) {
+                    return packed.insert(key);
+                }
+            } else if (mode == Mode::PACKED) {
+                problem.pack(state, key);
+                return packed.insert(key);
+            }
+        }
+        return states.insert(state).second;
+    }
+
+    std::size_t size() const { return mode == Mode::PACKED ? packed.size() : states.size(); }
+
+    /// Approximate bytes held: the packed table, or the states and their hash nodes.
+    std::size_t memory_usage() const {
+        if (mode == Mode::PACKED) {
+            return packed.memory_usage();
+        }
+        return states.size() * (sizeof(typename P::state_type) + 2 * sizeof(void *)) + states.bucket_count() * sizeof(void *);
+    }
+
+    /// Forgets every state, keeping the memory of the table in use; the next state inserted picks the mode again.
+    void clear() {
+        packed.clear();
+        states.clear();
+        mode = Mode::UNDECIDED;
+    }
+
+    /// True when the compact packed-key table is in use.
+    bool is_packed() const { return mode == Mode::PACKED; }
+
+private:
+    enum class Mode { UNDECIDED, PACKED, STATES };
+    const P &problem;
+    Mode mode = Mode::UNDECIDED;
+    PackedKeySet packed;
+    std::unordered_set<typename P::state_type, ProblemHash<P>, ProblemEqual<P>> states;
+};
+
+/**
+ * @brief Visited set shared by threads that generate states concurrently.
+ *
+ * Each state is claimed with a rank, and the lowest rank wins regardless of the order in which threads get there.
+ * Once all claims of a round are in, claimed_by() tells every candidate whether it won, so the survivors are deterministic.
+ * The set is split into independently locked shards picked from the state's hash, so threads rarely wait on each other.
+ * States are keyed by packed 64-bit key when the problem supports it, as in VisitedSet.
+ */
+template <SearchProblem P>
+class ConcurrentVisitedSet {
+public:
+    using state_type = typename P::state_type;
+
+    explicit ConcurrentVisitedSet(const P &problem, std::size_t shard_count = 64) : problem(problem) {
+        for (std::size_t i = 0; i < shard_count; i++) {
+            shards.push_back(std::make_unique<Shard>(problem));
+        }
+    }
+
+    /**
+     * @brief Claims a state.
+     *
+     * @param state The state to claim.
+     * @param rank Priority of the claim; lower ranks win.
+     * @return True if the state was unclaimed or only held by a higher rank, which this claim now replaces.
+     */
+    bool claim(const state_type &state, std::uint64_t rank) {
+        std::uint64_t key;
+        bool packed = pack(state, key);
+        Shard &shard = *shards[mix_bits(packed ? key : problem.hash(state)) % shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (packed) {
+            return lower(shard.packed.try_emplace(key, rank), rank);
+        }
+        return lower(shard.states.try_emplace(state, rank), rank);
+    }
+
+    /// True if the lowest claim on the state so far has the given rank.
+    bool claimed_by(const state_type &state, std::uint64_t rank) const {
+        std::uint64_t key;
+        bool packed = pack(state, key);
+        Shard &shard = *shards[mix_bits(packed ? key : problem.hash(state)) % shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (packed) {
+            auto found = shard.packed.find(key);
+            return found != shard.packed.end() && found->second == rank;
+        }
+        auto found = shard.states.find(state);
+        return found != shard.states.end() && found->second == rank;
+    }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->packed.size() + shard->states.size();
+        }
+        return total;
+    }
+
+    /// Approximate bytes held by the shards' entries and buckets.
+    std::size_t memory_usage() const {
+        std::size_t total = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->packed.size() * (2 * sizeof(std::uint64_t) + 2 * sizeof(void *)) +
+                     shard->states.size() * (sizeof(state_type) + sizeof(std::uint64_t) + 2 * sizeof(void *)) +
+                     (shard->packed.bucket_count() + shard->states.bucket_count()) * sizeof(void *);
+        }
+        return total;
+    }
+
+private:
+    struct Shard {
+        explicit Shard(const P &problem) : states(0, ProblemHash<P>{&problem}, ProblemEqual<P>{&problem}) {}
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::uint64_t> packed;
+        std::unordered_map<state_type, std::uint64_t, ProblemHash<P>, ProblemEqual<P>> states;
+    };
+
+    const P &problem;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    bool pack(const state_type &state, std::uint64_t &key) const {
+        if constexpr (PackableProblem<P>) {
+            return problem.pack(state, key);
+        } else {
+            return false;
+        }
+    }
+
+    template <class Result>
+    static bool lower(Result result, std::uint64_t rank) {
+        auto &[entry, inserted] = result;
+        if (inserted) {
+            return true;
+        }
+        if (rank < entry->second) {
+            entry->second = rank;
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // VISITED_SET_H
@@ -0,0 +1,206 @@
+/**
+ * @file work_stealing_pool.h
+ * @brief Persistent thread pool that splits index ranges between its workers and lets idle workers steal from busy ones.
+ */
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Runs a task for every index of a range on a fixed set of worker threads.
+ *
+ * Each run() splits the indices into one contiguous block per worker. A worker takes indices from the front of its own block,
+ * and when that runs out steals the back half of another worker's block, so uneven tasks (a hard instance among easy ones)
+ * still keep every thread busy. The thread calling run() works as worker 0; the other workers are threads started once
+ * by the constructor and parked between runs.
+ *
+ * Runs from several threads are serialized. A task must not call run() on the pool it runs on.
+ */
+class WorkStealingPool {
+public:
+    /// @param threads Workers, including the thread calling run(); 0 uses the hardware concurrency.
+    explicit WorkStealingPool(unsigned threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        blocks = std::make_unique<Block[]>(threads);
+        workers = threads;
+        for (unsigned id = 1; id < threads; id++) {
+            background.emplace_back([this, id] { park(id); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : background) {
+            thread.join();
+        }
+    }
+
+    /// A pool with one worker per hardware thread, started on first use and shared by the whole process.
+    static WorkStealingPool &shared() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    /// Workers, including the thread calling run().
+    unsigned size() const { return workers; }
+
+    /// Blocks taken from other workers over the pool's lifetime.
+    std::uint64_t steals() const { return stolen.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Calls task(worker, index) once for every index in [0, count) and returns when all calls have returned.
+     *
+     * worker is the id of the calling worker, below size(), so tasks can keep per-worker state in an array.
+     * If a task throws, no new indices are handed out and the first exception is rethrown once the running tasks finish.
+     */
+    void run(std::size_t count, const std::function<void(unsigned worker, std::size_t index)> &task) {
+        std::lock_guard<std::mutex> serial(running);
+        if (count == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (unsigned id = 0; id < workers; id++) {
+                std::lock_guard<std::mutex> block_lock(blocks[id].mutex);
+                blocks[id].next = count * id / workers;
+                blocks[id].end = count * (id + 1) / workers;
+            }
+            job = &task;
+            failure = nullptr;
+            aborted.store(false, std::memory_order_relaxed);
+            busy = workers - 1;
+            generation++;
+        }
+        wake.notify_all();
+        work(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+        job = nullptr;
+        if (failure) {
+            std::rethrow_exception(std::exchange(failure, nullptr));
+        }
+    }
+
+private:
+    // Indices [next, end) not handed out yet; on its own cache line, as its owner and thieves lock it from different threads
+    struct alignas(64) Block {
+        std::mutex mutex;
+        std::size_t next = 0;
+        std::size_t end = 0;
+    };
+
+    unsigned workers = 1;
+    std::unique_ptr<Block[]> blocks;
+    std::vector<std::thread> background;
+    std::mutex running;  // Serializes run()
+    std::mutex mutex;    // Guards the fields below, which describe the current run
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(unsigned, std::size_t)> *job = nullptr;
+    std::exception_ptr failure;
+    std::uint64_t generation = 0;
+    unsigned busy = 0;  // Background workers still in the current run
+    bool stopping = false;
+    std::atomic<bool> aborted{false};
+    std::atomic<std::uint64_t> stolen{0};
+
+    void park(unsigned id) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(id);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    void work(unsigned id) {
+        std::size_t index;
+        while (!aborted.load(std::memory_order_relaxed) && next_index(id, index)) {
+            try {
+                (*job)(id, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                aborted.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Takes the next index of the worker's block, refilling the block from another worker's when it is empty.
+    bool next_index(unsigned id, std::size_t &index) {
+        Block &own = blocks[id];
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.next < own.end) {
+                    index = own.next++;
+                    return true;
+                }
+            }
+            if (!steal(id)) {
+                // Indices are only ever handed out, so once every block is empty the run is over for this worker
+                return false;
+            }
+        }
+    }
+
+    bool steal(unsigned id) {
+        for (unsigned k = 1; k < workers; k++) {
+            Block &victim = blocks[(id + k) % workers];
+            std::size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                std::size_t left = victim.end - victim.next;
+                if (left == 0) {
+                    continue;
+                }
+                end = victim.end;
+                begin = end - (left + 1) / 2;
+                victim.end = begin;
+            }
+            std::lock_guard<std::mutex> lock(blocks[id].mutex);
+            blocks[id].next = begin;
+            blocks[id].end = end;
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // WORK_STEALING_POOL_H
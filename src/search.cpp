@@ -1,29 +1,163 @@
 #include "search.h"
-#include "utils.cpp"
-#include <queue>
+#include "engine/anytime_astar.h"
+#include "engine/astar.h"
+#include "engine/beam.h"
+#include "engine/bfs.h"
+#include "engine/bidirectional.h"
+#include "engine/idastar.h"
+#include "engine/memory_bounded.h"
+#include "engine/parallel_astar.h"
+#include "engine/parallel_bfs.h"
 #include <memory>
 #include <iostream>
-#include <unordered_set>
-#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
-#include <functional>
 
 
-Search *create_search(SearchAlgorithmIndex search_algorithm_index, Problem *problem) {
+Search *create_search(SearchAlgorithmIndex search_algorithm_index, Problem *problem, const SearchConfig &config) {
+    Search *search = nullptr;
     switch (search_algorithm_index) {
         case BREADTH_FIRST_SEARCH:
-            return new BreadthFirstSearch(problem);
+            search = new BreadthFirstSearch(problem, true, config.bfs_threads);
+            break;
+        case UNIFORM_COST_SEARCH:
+            search = new UniformCostSearch(problem, config.frontier);
+            break;
         case A_STAR:
-            return new AStarSearch(problem);
+            search = new AStarSearch(problem, config.frontier);
+            break;
         case BEAM_SEARCH:
-            return new BeamSearch(problem, 2);
+            search = new BeamSearch(problem, config.beam_width, config.beam_deduplicate, config.beam_bounded_layer);
+            break;
+        case PARALLEL_A_STAR:
+            search = new ParallelAStarSearch(problem, config.threads, config.frontier);
+            break;
+        case BIDIRECTIONAL_SEARCH:
+            search = new BidirectionalSearch(problem, true, config.frontier);
+            break;
+        case IDA_STAR:
+            search = new IDAStarSearch(problem, config.ida_transposition_entries);
+            break;
+        case MEMORY_BOUNDED_A_STAR:
+            search = new MemoryBoundedAStarSearch(problem, config.memory_budget, config.memory_bounded_expansions);
+            break;
+        case D_STAR_LITE:
+            search = new DStarLiteSearch(problem);
+            break;
+        case ANYTIME_A_STAR:
+            search = new AnytimeAStarSearch(problem, config.anytime_initial_weight, config.anytime_weight_step);
+            break;
         default:
             return nullptr;
     }
+    search->phase_timers = config.phase_timers;
+    search->heuristic_cache_entries = config.heuristic_cache_entries;
+    search->heuristic_cache_eviction = config.heuristic_cache_eviction;
+    search->limits.seconds = config.time_limit;
+    search->limits.expansions = config.node_limit;
+    search->limits.memory = config.memory_limit;
+    return search;
+}
+
+namespace {
+
+/// Calls run with the adapter, or with a heuristic cache in front of it when the search asks for one.
+template <class Run>
+std::shared_ptr<Node> with_heuristic_cache(const Search &search, const VirtualProblem &adapter, Run run) {
+    if (search.heuristic_cache_entries == 0) {
+        return run(adapter);
+    }
+    CachedHeuristic<VirtualProblem> cached(adapter, search.heuristic_cache_entries, search.heuristic_cache_eviction);
+    return run(cached);
+}
+
+/// Builds the Node chain for the path ending at the goal, naming actions through the problem.
+std::shared_ptr<Node> build_path(Problem *problem, const NodeArena<SearchNode> &nodes, NodeId goal) {
+    std::shared_ptr<Node> node;
+    if (goal == NO_NODE) {
+        return node;
+    }
+    for (NodeId id : nodes.path_to(goal)) {
+        const SearchNode &record = nodes[id];
+        std::shared_ptr<Action> action;
+        if (node) {
+            action = std::make_shared<Action>(problem->action_name(record.action), record.path_cost - node->path_cost, node->state, record.state);
+        }
+        node = std::make_shared<Node>(node, record.state, action, record.path_cost, record.heuristic);
+    }
+    return node;
+}
+
+/// Runs a batch with engines from make_engine, configured with the options and limits every algorithm shares.
+template <class MakeEngine>
+BatchReport<std::shared_ptr<Node>> run_batch(WorkStealingPool &pool, const std::vector<VirtualProblem> &adapters, const SearchConfig &config,
+                                             MakeEngine make_engine) {
+    std::vector<const VirtualProblem *> instances;
+    for (const VirtualProblem &adapter : adapters) {
+        instances.push_back(&adapter);
+    }
+    return solve_batch<VirtualProblem>(pool, instances, [&](const ProblemSlot<VirtualProblem> &slot) {
+        auto engine = make_engine(slot);
+        engine.phase_timers = config.phase_timers;
+        engine.limits.seconds = config.time_limit;
+        engine.limits.expansions = config.node_limit;
+        engine.limits.memory = config.memory_limit;
+        return engine;
+    }, [](const auto &engine, NodeId goal, const VirtualProblem &instance) {
+        return build_path(instance.problem, engine.nodes(), goal);
+    });
+}
+
+} // namespace
+
+BatchReport<std::shared_ptr<Node>> solve_batch(std::span<Problem *const> problems, SearchAlgorithmIndex search_algorithm_index,
+                                               const SearchConfig &config, WorkStealingPool &pool) {
+    std::vector<VirtualProblem> adapters(problems.begin(), problems.end());
+    using Slot = ProblemSlot<VirtualProblem>;
+    switch (search_algorithm_index) {
+        case BREADTH_FIRST_SEARCH:
+            return run_batch(pool, adapters, config, [](const Slot &slot) { return BFS<Slot>(slot); });
+        case UNIFORM_COST_SEARCH:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) { return UniformCost<Slot>(slot, config.frontier); });
+        case A_STAR:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) { return AStar<Slot>(slot, config.frontier); });
+        case BEAM_SEARCH:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) {
+                return Beam<Slot>(slot, config.beam_width, config.beam_deduplicate, config.beam_bounded_layer);
+            });
+        case BIDIRECTIONAL_SEARCH:
+            for (const VirtualProblem &adapter : adapters) {
+                if (!adapter.goal()) {
+                    throw std::logic_error("Bidirectional search needs a problem with a goal state");
+                }
+            }
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) { return Bidirectional<Slot>(slot, true, config.frontier); });
+        case IDA_STAR:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) { return IDAStar<Slot>(slot, config.ida_transposition_entries); });
+        case MEMORY_BOUNDED_A_STAR:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) {
+                return MemoryBoundedAStar<Slot>(slot, config.memory_budget, config.memory_bounded_expansions);
+            });
+        case ANYTIME_A_STAR:
+            return run_batch(pool, adapters, config, [&config](const Slot &slot) {
+                return AnytimeAStar<Slot>(slot, config.anytime_initial_weight, config.anytime_weight_step);
+            });
+        default:
+            throw std::invalid_argument("Batches run one search per thread; use a sequential algorithm");
+    }
 }
 
 BreadthFirstSearch::~BreadthFirstSearch() { }
 
+std::future<std::shared_ptr<Node>> Search::search_async() {
+    return std::async(std::launch::async, [this] { return search(); });
+}
+
+std::shared_ptr<Node> Search::materialize(const NodeArena<SearchNode> &nodes, NodeId goal) {
+    return build_path(problem, nodes, goal);
+}
+
 void Solution::print() {
     Node * current = this->node;
     std::vector<Action> actions;
@@ -42,144 +176,111 @@ void Solution::print() {
 }
 
 std::shared_ptr<Node> BreadthFirstSearch::search() {
-    std::queue<std::shared_ptr<Node>> frontier;
-    auto initial_state = problem->initial_state();
-    auto root = std::make_shared<Node>(
-        nullptr,
-        std::shared_ptr<State>(initial_state),
-        nullptr,
-        0,
-        problem->heuristic(initial_state)
-    );
-    frontier.push(root);
-    while (!frontier.empty()) {
-        auto node = frontier.front();
-        frontier.pop();
-
-        State *state = node->state.get();
-        if (problem->goal_test(state)) {
-            return node;
-        }
-        for (const auto &action : problem->actions(node->state)) {
-            auto child = std::make_shared<Node>(
-                std::shared_ptr<Node>(node),
-                action->effect,
-                action,
-                node->path_cost + action->cost,
-                problem->heuristic(action->effect.get())
-            );
-            frontier.push(child);
-        }
+    VirtualProblem adapter(problem);
+    if (threads != 1) {
+        ParallelBFS<VirtualProblem> engine(adapter, threads, eliminate_duplicates);
+        return run(engine);
     }
-    // Return nullptr if no solution is found
-    return nullptr;
+    BFS<VirtualProblem> engine(adapter, eliminate_duplicates);
+    return run(engine);
 }
 
 AStarSearch::~AStarSearch() { }
 
 std::shared_ptr<Node> AStarSearch::search() {
-    std::priority_queue<std::shared_ptr<Node>, std::vector<std::shared_ptr<Node>>, NodeComparator> frontier;
-    // Initialize the root node with the problem's initial state
-    std::unordered_set<std::shared_ptr<State>> explored; // Set of explored states
-    auto initial_state = problem->initial_state();
-    auto root = std::make_shared<Node>(
-        nullptr,                    // Parent node
-        std::shared_ptr<State>(initial_state), // Initial state (shared_ptr)
-        nullptr,                    // No action
-        0,                          // Path cost
-        problem->heuristic(initial_state) // Heuristic value
-    );
-    frontier.push(root);
-
-    while (!frontier.empty()) {
-        auto node = frontier.top();
-        frontier.pop();
-
-        // Check if the goal state is reached
-        State *state = node->state.get();
-        if (problem->goal_test(state)) {
-            return node;
-        }
+    VirtualProblem adapter(problem);
+    return with_heuristic_cache(*this, adapter, [this](const auto &adapted) {
+        AStar<std::decay_t<decltype(adapted)>> engine(adapted, frontier);
+        return run(engine);
+    });
+}
 
-        // Skip the node if it has already been explored
-        if (explored.find(node->state) != explored.end()) {
-            continue;
-        }
-        explored.insert(node->state);
-
-        // Expand the node by generating its child nodes
-        for (const auto &action : problem->actions(node->state)) {
-            auto child = std::make_shared<Node>(
-                std::shared_ptr<Node>(node), // Parent node
-                action->effect,
-                action,                    // Pointer to the action
-                node->path_cost + action->cost, // Path cost
-                problem->heuristic(action->effect.get()) // Heuristic value
-            );
-            frontier.push(child);
-        }
-    }
+UniformCostSearch::~UniformCostSearch() { }
 
-    // Return nullptr if no solution is found
-    return nullptr;
+std::shared_ptr<Node> UniformCostSearch::search() {
+    VirtualProblem adapter(problem);
+    UniformCost<VirtualProblem> engine(adapter, frontier);
+    return run(engine);
 }
 
+BeamSearch::~BeamSearch() { }
 
+std::shared_ptr<Node> BeamSearch::search() {
+    VirtualProblem adapter(problem);
+    Beam<VirtualProblem> engine(adapter, beam_width, deduplicate, bounded_layer);
+    return run(engine);
+}
 
+ParallelAStarSearch::~ParallelAStarSearch() { }
 
-BeamSearch::~BeamSearch() { }
+std::shared_ptr<Node> ParallelAStarSearch::search() {
+    VirtualProblem adapter(problem);
+    ParallelAStar<VirtualProblem> engine(adapter, threads, frontier);
+    return run(engine);
+}
 
-std::shared_ptr<Node> BeamSearch::search() {
-    // Priority queue to maintain the beam
-    using Beam = std::vector<std::shared_ptr<Node>>;
-    Beam beam;
-
-    // Initialize the root node
-    auto initial_state = problem->initial_state();
-    auto root = std::make_shared<Node>(
-        nullptr,
-        std::shared_ptr<State>(initial_state),
-        nullptr,
-        0,
-        problem->heuristic(initial_state)
-    );
-
-    beam.push_back(root);
-
-    while (!beam.empty()) {
-        // Sort beam nodes based on their f(n) = path_cost + heuristic
-        std::sort(beam.begin(), beam.end(), [](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b) {
-            return (a->path_cost + a->heuristic) < (b->path_cost + b->heuristic);
-        });
-
-        // Keep only the top k nodes (beam width)
-        if (beam.size() > beam_width) {
-            beam.resize(beam_width);
-        }
+BidirectionalSearch::~BidirectionalSearch() { }
 
-        Beam next_beam;
+std::shared_ptr<Node> BidirectionalSearch::search() {
+    VirtualProblem adapter(problem);
+    if (!adapter.goal()) {
+        throw std::logic_error("Bidirectional search needs a problem with a goal state");
+    }
+    Bidirectional<VirtualProblem> engine(adapter, use_heuristic, frontier);
+    return run(engine);
+}
 
-        // Expand each node in the current beam
-        for (const auto& node : beam) {
-            if (problem->goal_test(node->state.get())) {
-                return node; // Goal found
-            }
+IDAStarSearch::~IDAStarSearch() { }
 
-            // Generate successors
-            for (const auto& action : problem->actions(node->state)) {
-                auto child = std::make_shared<Node>(
-                    node,
-                    action->effect,
-                    action,
-                    node->path_cost + action->cost,
-                    problem->heuristic(action->effect.get())
-                );
-                next_beam.push_back(child);
-            }
-        }
+std::shared_ptr<Node> IDAStarSearch::search() {
+    VirtualProblem adapter(problem);
+    return with_heuristic_cache(*this, adapter, [this](const auto &adapted) {
+        IDAStar<std::decay_t<decltype(adapted)>> engine(adapted, transposition_entries);
+        return run(engine);
+    });
+}
+
+MemoryBoundedAStarSearch::~MemoryBoundedAStarSearch() { }
+
+std::shared_ptr<Node> MemoryBoundedAStarSearch::search() {
+    VirtualProblem adapter(problem);
+    return with_heuristic_cache(*this, adapter, [this](const auto &adapted) {
+        MemoryBoundedAStar<std::decay_t<decltype(adapted)>> engine(adapted, memory_budget, expansion_limit);
+        std::shared_ptr<Node> node = run(engine);
+        best_effort = engine.best_effort();
+        return node;
+    });
+}
+
+AnytimeAStarSearch::~AnytimeAStarSearch() { }
 
-        beam = std::move(next_beam);
+std::shared_ptr<Node> AnytimeAStarSearch::search() {
+    VirtualProblem adapter(problem);
+    AnytimeAStar<VirtualProblem> engine(adapter, initial_weight, weight_step);
+    if (on_solution) {
+        engine.on_solution = [this, &engine](const AnytimeSolution &solution) {
+            on_solution(materialize(engine.nodes(), solution.goal), solution.bound);
+        };
     }
+    std::shared_ptr<Node> node = run(engine);
+    suboptimality_bound = engine.suboptimality_bound();
+    interrupted = engine.interrupted();
+    return node;
+}
+
+DStarLiteSearch::~DStarLiteSearch() { }
+
+std::shared_ptr<Node> DStarLiteSearch::search() {
+    if (!adapter.goal()) {
+        throw std::logic_error("D* Lite needs a problem with a goal state");
+    }
+    return run(engine);
+}
+
+void DStarLiteSearch::changed(std::shared_ptr<State> state) {
+    engine.changed(state);
+}
 
-    return nullptr;
+void DStarLiteSearch::reset() {
+    engine.reset();
 }
@@ -0,0 +1,105 @@
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+
+const char *status_name(SearchStatus status) {
+    switch (status) {
+        case SearchStatus::SOLVED:
+            return "solved";
+        case SearchStatus::NO_SOLUTION:
+            return "no_solution";
+        case SearchStatus::CANCELLED:
+            return "cancelled";
+        case SearchStatus::TIME_LIMIT:
+            return "time_limit";
+        case SearchStatus::NODE_LIMIT:
+            return "node_limit";
+        case SearchStatus::MEMORY_LIMIT:
+            return "memory_limit";
+    }
+    return "unknown";
+}
+
+double SearchStats::branching_factor() const {
+    if (!solved || solution_depth == 0 || generated == 0) {
+        return 0.0;
+    }
+    double target = static_cast<double>(generated) + 1.0;
+    auto nodes = [this](double b) {
+        double total = 1.0;
+        double layer = 1.0;
+        for (std::size_t depth = 0; depth < solution_depth; depth++) {
+            layer *= b;
+            total += layer;
+        }
+        return total;
+    };
+    // A uniform tree with b = generated already holds more nodes than generated + 1
+    double low = 0.0;
+    double high = std::max(1.0, static_cast<double>(generated));
+    for (int i = 0; i < 100 && high - low > 1e-9; i++) {
+        double mid = (low + high) / 2;
+        if (nodes(mid) < target) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2;
+}
+
+SearchStats &SearchStats::operator+=(const SearchStats &other) {
+    expanded += other.expanded;
+    generated += other.generated;
+    duplicates += other.duplicates;
+    heuristic_calls += other.heuristic_calls;
+    heuristic_cache_hits += other.heuristic_cache_hits;
+    heuristic_cache_misses += other.heuristic_cache_misses;
+    peak_frontier = std::max(peak_frontier, other.peak_frontier);
+    peak_nodes = std::max(peak_nodes, other.peak_nodes);
+    peak_memory = std::max(peak_memory, other.peak_memory);
+    expand_seconds += other.expand_seconds;
+    heuristic_seconds += other.heuristic_seconds;
+    queue_seconds += other.queue_seconds;
+    return *this;
+}
+
+std::string SearchStats::to_json() const {
+    std::ostringstream out;
+    out << "{\"expanded\":" << expanded
+        << ",\"generated\":" << generated
+        << ",\"duplicates\":" << duplicates
+        << ",\"heuristic_calls\":" << heuristic_calls
+        << ",\"heuristic_cache_hits\":" << heuristic_cache_hits
+        << ",\"heuristic_cache_misses\":" << heuristic_cache_misses
+        << ",\"heuristic_cache_hit_rate\":" << heuristic_cache_hit_rate()
+        << ",\"peak_frontier\":" << peak_frontier
+        << ",\"peak_nodes\":" << peak_nodes
+        << ",\"peak_memory\":" << peak_memory
+        << ",\"solved\":" << (solved ? "true" : "false")
+        << ",\"status\":\"" << status_name(status) << '"'
+        << ",\"solution_cost\":" << solution_cost
+        << ",\"solution_depth\":" << solution_depth
+        << ",\"branching_factor\":" << branching_factor()
+        << ",\"search_seconds\":" << search_seconds
+        << ",\"expand_seconds\":" << expand_seconds
+        << ",\"heuristic_seconds\":" << heuristic_seconds
+        << ",\"queue_seconds\":" << queue_seconds << "}";
+    return out.str();
+}
+
+std::string SearchStats::csv_header() {
+    return "expanded,generated,duplicates,heuristic_calls,heuristic_cache_hits,heuristic_cache_misses,heuristic_cache_hit_rate,peak_frontier,peak_nodes,peak_memory,solved,status,solution_cost,solution_depth,"
+           "branching_factor,search_seconds,expand_seconds,heuristic_seconds,queue_seconds";
+}
+
+std::string SearchStats::to_csv() const {
+    std::ostringstream out;
+    out << expanded << ',' << generated << ',' << duplicates << ',' << heuristic_calls << ',' << heuristic_cache_hits << ','
+        << heuristic_cache_misses << ',' << heuristic_cache_hit_rate() << ',' << peak_frontier << ',' << peak_nodes << ','
+        << peak_memory << ',' << (solved ? 1 : 0) << ',' << status_name(status) << ',' << solution_cost << ',' << solution_depth << ',' << branching_factor() << ','
+        << search_seconds << ',' << expand_seconds << ',' << heuristic_seconds << ',' << queue_seconds;
+    return out.str();
+}
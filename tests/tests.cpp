@@ -1,6 +1,37 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <random>
+#include <span>
+#include <thread>
 #include "definitions.h"
+#include "heuristic_kernels.h"
 #include "search.h"
+#include "visited_set.h"
+#include "work_stealing_pool.h"
+#include "engine/anytime_astar.h"
+#include "engine/batch.h"
+#include "engine/astar.h"
+#include "engine/beam.h"
+#include "engine/bidirectional.h"
+#include "engine/dstar_lite.h"
+#include "engine/heuristic_cache.h"
+#include "engine/idastar.h"
+#include "engine/memory_bounded.h"
+#include "engine/pattern_database.h"
+#include "engine/bfs.h"
+#include "engine/parallel_astar.h"
+#include "engine/parallel_bfs.h"
+#include "problems/simple_maze.h"
+#include "problems/study_path.h"
+#include "problems/task_scheduler.h"
+#include "problems/vacuum.h"
 
 class TestState : public State {
 public:
@@ -32,6 +63,110 @@ public:
     }
 };
 
+// States on a number line; stepping back and forth reaches the same value along many paths.
+class LineState : public State {
+public:
+    int value;
+    LineState(int value) : value(value) {}
+    std::size_t hash() const override { return std::hash<int>{}(value); }
+    bool equals(const State &other) const override {
+        auto *line_state = dynamic_cast<const LineState *>(&other);
+        return line_state && line_state->value == value;
+    }
+};
+
+class LineProblem : public Problem {
+public:
+    int expansions = 0;
+    LineProblem() {
+        initial_state_ = new LineState(0);
+    }
+    bool goal_test(State *state) override {
+        return dynamic_cast<LineState *>(state)->value == 10;
+    }
+    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
+        auto line_state = std::dynamic_pointer_cast<LineState>(state);
+        expansions++;
+        std::vector<std::shared_ptr<Action>> actions;
+        actions.push_back(std::make_shared<Action>("Forward", 1, state, std::make_shared<LineState>(line_state->value + 1)));
+        actions.push_back(std::make_shared<Action>("Back", 1, state, std::make_shared<LineState>(line_state->value - 1)));
+        return actions;
+    }
+    double heuristic(State *) override {
+        return 0;
+    }
+};
+
+// Grid walk known at compile time: plain value states, no virtual calls.
+struct GridWalk {
+    struct Cell {
+        int x;
+        int y;
+    };
+    using state_type = Cell;
+    int size = 20;
+
+    Cell initial() const { return {0, 0}; }
+    bool is_goal(const Cell &cell) const { return cell.x == size - 1 && cell.y == size - 1; }
+    double h(const Cell &cell) const { return (size - 1 - cell.x) + (size - 1 - cell.y); }
+    std::size_t hash(const Cell &cell) const { return cell.x * 1024 + cell.y; }
+    bool equal(const Cell &a, const Cell &b) const { return a.x == b.x && a.y == b.y; }
+    bool pack(const Cell &cell, std::uint64_t &key) const {
+        key = hash(cell);
+        return true;
+    }
+    void expand(const Cell &cell, SuccessorBuffer<Cell> &out) const {
+        if (cell.x + 1 < size) out.emplace(0, 1, Cell{cell.x + 1, cell.y});
+        if (cell.y + 1 < size) out.emplace(1, 1, Cell{cell.x, cell.y + 1});
+        if (cell.x > 0) out.emplace(2, 1, Cell{cell.x - 1, cell.y});
+        if (cell.y > 0) out.emplace(3, 1, Cell{cell.x, cell.y - 1});
+    }
+};
+
+static_assert(SearchProblem<GridWalk>);
+static_assert(PackableProblem<GridWalk>);
+static_assert(SearchProblem<VirtualProblem>);
+
+// Weighted graph where the fewest-steps path is not the cheapest one.
+class WeightedGraphState : public State {
+public:
+    char node;
+    WeightedGraphState(char node) : node(node) {}
+    std::size_t hash() const override { return std::hash<char>{}(node); }
+    bool equals(const State &other) const override {
+        auto *graph_state = dynamic_cast<const WeightedGraphState *>(&other);
+        return graph_state && graph_state->node == node;
+    }
+};
+
+class WeightedGraphProblem : public Problem {
+public:
+    std::multimap<char, std::pair<char, double>> edges = {
+        {'A', {'B', 1.5}}, {'A', {'D', 7.0}}, {'A', {'C', 4.0}},
+        {'B', {'C', 1.0}}, {'B', {'D', 6.0}},
+        {'C', {'D', 1.25}}, {'C', {'A', 0.5}},
+    };
+    WeightedGraphProblem() {
+        initial_state_ = new WeightedGraphState('A');
+    }
+    bool goal_test(State *state) override {
+        return static_cast<WeightedGraphState *>(state)->node == 'D';
+    }
+    std::vector<std::shared_ptr<Action>> actions(std::shared_ptr<State> state) override {
+        char node = std::static_pointer_cast<WeightedGraphState>(state)->node;
+        std::vector<std::shared_ptr<Action>> actions;
+        auto [first, last] = edges.equal_range(node);
+        for (auto it = first; it != last; ++it) {
+            actions.push_back(std::make_shared<Action>(std::string(1, node) + "->" + it->second.first, it->second.second, state,
+                                                       std::make_shared<WeightedGraphState>(it->second.first)));
+        }
+        return actions;
+    }
+    double heuristic(State *) override {
+        return 0;
+    }
+};
+
 TEST(Definitions, State) {
     State state;
     EXPECT_NO_THROW(state.print());
@@ -64,6 +199,1797 @@ TEST(Search, BeamSearch) {
     delete search;
 }
 
+TEST(Definitions, StateIdentityByDefault) {
+    State a;
+    State b;
+    EXPECT_TRUE(a.equals(a));
+    EXPECT_FALSE(a.equals(b));
+}
+
+TEST(Definitions, StateContentEquality) {
+    auto a = std::make_shared<LineState>(3);
+    auto b = std::make_shared<LineState>(3);
+    EXPECT_TRUE(StateEqual{}(a, b));
+    EXPECT_EQ(StateHash{}(a), StateHash{}(b));
+    EXPECT_FALSE(StateEqual{}(a, std::make_shared<LineState>(4)));
+}
+
+TEST(Search, AStarSearchPrunesDuplicateStates) {
+    LineProblem problem;
+    Search *search = create_search(SearchAlgorithmIndex::A_STAR, &problem);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, 10);
+    // Without a content-keyed closed set the zero heuristic would expand every path of length <= 10
+    EXPECT_LE(problem.expansions, 25);
+    delete search;
+}
+
+TEST(VisitedSet, PackedKeySetGrows) {
+    PackedKeySet keys(4);
+    for (std::uint64_t key = 0; key < 1000; key++) {
+        EXPECT_TRUE(keys.insert(key * 7919));
+    }
+    EXPECT_FALSE(keys.insert(7919));
+    EXPECT_TRUE(keys.contains(999 * 7919));
+    EXPECT_FALSE(keys.contains(1));
+    EXPECT_EQ(keys.size(), 1000);
+}
+
+TEST(VisitedSet, UsesPackedKeysWhenStatesPack) {
+    MazeProblem problem;
+    VirtualProblem adapter(&problem);
+    VisitedSet<VirtualProblem> visited(adapter);
+    EXPECT_TRUE(visited.insert(std::make_shared<MazeState>(0, 0)));
+    EXPECT_FALSE(visited.insert(std::make_shared<MazeState>(0, 0)));
+    EXPECT_TRUE(visited.is_packed());
+}
+
+TEST(Search, BreadthFirstSearchEliminatesDuplicates) {
+    LineProblem problem;
+    BreadthFirstSearch search(&problem);
+    std::shared_ptr<Node> node = search.search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, 10);
+    // Each value in [-10, 9] is expanded at most once
+    EXPECT_LE(problem.expansions, 21);
+}
+
+TEST(Search, BreadthFirstSearchMaze) {
+    MazeProblem problem;
+    BreadthFirstSearch search(&problem);
+    std::shared_ptr<Node> node = search.search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_TRUE(problem.goal_test(node->state.get()));
+}
+
+TEST(NodeArena, PathWalksParentIndices) {
+    struct Record { int value; NodeId parent; };
+    NodeArena<Record> arena;
+    NodeId parent = NO_NODE;
+    for (int i = 0; i < 10000; i++) {
+        parent = arena.emplace(i, parent);
+    }
+    Record &first = arena[0];
+    arena.emplace(-1, NO_NODE);
+    EXPECT_EQ(&first, &arena[0]); // chunks never relocate
+    auto path = arena.path_to(parent);
+    ASSERT_EQ(path.size(), 10000);
+    EXPECT_EQ(arena[path.front()].value, 0);
+    EXPECT_EQ(arena[path.back()].value, 9999);
+    arena.clear();
+    EXPECT_EQ(arena.size(), 0);
+}
+
+TEST(NodeArena, RefusesIndicesPastNoNode) {
+    struct Record { int value; NodeId parent; };
+    NodeArena<Record> arena;
+    arena.emplace(0, NO_NODE);
+    // Checked before allocating, so the arena is left as it was
+    EXPECT_THROW(arena.grow(NodeArena<Record>::MAX_NODES), std::length_error);
+    EXPECT_EQ(arena.size(), 1);
+    EXPECT_EQ(arena.grow(2), 1);
+    EXPECT_EQ(arena.size(), 3);
+}
+
+TEST(Search, SearchCanRunTwice) {
+    TestProblem problem;
+    AStarSearch search(&problem);
+    auto first = search.search();
+    auto second = search.search();
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(first->path_cost, second->path_cost);
+    auto root = first;
+    while (root->parent) {
+        root = root->parent;
+    }
+    EXPECT_EQ(root->state.get(), problem.initial_state());
+}
+
+TEST(Engine, TypedEnginesSolveGridWalk) {
+    GridWalk problem;
+    AStar<GridWalk> astar(problem);
+    NodeId goal = astar.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(astar.nodes()[goal].path_cost, 38);
+    EXPECT_EQ(astar.path(goal).size(), 39);
+
+    BFS<GridWalk> bfs(problem);
+    goal = bfs.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(bfs.nodes()[goal].path_cost, 38);
+    EXPECT_LE(bfs.nodes().size(), 400);
+
+    Beam<GridWalk> beam(problem, 4);
+    goal = beam.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_TRUE(problem.is_goal(beam.nodes()[goal].state));
+}
+
+TEST(Engine, BundledProblemsRunOnTypedEngines) {
+    static_assert(SearchProblem<MazeProblem>);
+    static_assert(SearchProblem<VacuumCleaner>);
+    static_assert(SearchProblem<TaskScheduler>);
+
+    VacuumCleaner vacuum;
+    AStar<VacuumCleaner> vacuum_search(vacuum);
+    NodeId goal = vacuum_search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(vacuum_search.nodes()[goal].path_cost, 3);
+    EXPECT_EQ(vacuum.action_name(vacuum_search.nodes()[goal].action), "Suck");
+
+    TaskScheduler scheduler;
+    BFS<TaskScheduler> scheduler_search(scheduler);
+    goal = scheduler_search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(scheduler_search.nodes()[goal].path_cost, 3);
+}
+
+TEST(Engine, VacuumRoomsFitPackedKeys) {
+    VacuumCleaner widest(VacuumState::MAX_ROOMS);
+    VacuumState last(VacuumState::MAX_ROOMS - 1, std::uint64_t(1) << (VacuumState::MAX_ROOMS - 1));
+    VacuumState first(0, std::uint64_t(1) << (VacuumState::MAX_ROOMS - 1));
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    ASSERT_TRUE(widest.pack(last, a));
+    ASSERT_TRUE(widest.pack(first, b));
+    EXPECT_NE(a, b);
+    EXPECT_THROW(VacuumCleaner(VacuumState::MAX_ROOMS + 1), std::invalid_argument);
+    EXPECT_THROW(VacuumCleaner(0), std::invalid_argument);
+}
+
+TEST(Study, InternsTopicsIntoFixedPointArrays) {
+    StudyState state({{"Graphs", 80.0}, {"Algebra", 95.5}}, 10.0);
+    ASSERT_EQ(state.topic_count(), 2);
+    EXPECT_EQ(state.topics->name(0), "Algebra");
+    EXPECT_EQ(state.mastery[0], 9550);
+    EXPECT_DOUBLE_EQ(state.mastery_of(1), 80.0);
+    EXPECT_EQ(state.topics->find("Graphs"), 1);
+    EXPECT_EQ(state.topics->find("Poetry"), 2);
+
+    StudyState same(state.topics, state.mastery, 10.0);
+    EXPECT_TRUE(same.equals(state));
+    EXPECT_EQ(same.hash(), state.hash());
+    same.mastery[1]++;
+    EXPECT_FALSE(same.equals(state));
+
+    std::map<std::string, double> crowded;
+    for (std::size_t i = 0; i <= StudyTopics::MAX; i++) {
+        crowded["Topic " + std::to_string(1000 + i)] = 50.0;
+    }
+    EXPECT_THROW(StudyState(crowded, 10.0), std::invalid_argument);
+}
+
+TEST(Study, SynergiesShortenThePlan) {
+    StudyProblem plan(new StudyState({{"Algebra", 80.0}, {"Graphs", 95.0}}, 10.0),
+                      {{"Graphs", {"Algebra", "Poetry"}}}, {{"Graphs", 5.0}, {"Poetry", 20.0}});
+    EXPECT_EQ(plan.prerequisites(1), 1u);
+    EXPECT_EQ(plan.prerequisites(0), 0u);
+    EXPECT_DOUBLE_EQ(plan.synergy(1), 5.0);
+
+    AStar<StudyProblem> search(plan);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    // Algebra takes two sessions; Graphs reaches 105% in one
+    EXPECT_EQ(search.nodes()[goal].path_cost, 3);
+    EXPECT_EQ(search.nodes()[goal].state.mastery[1], 10500);
+    EXPECT_DOUBLE_EQ(search.nodes()[goal].state.remaining_time, 7.0);
+}
+
+TEST(Study, NegativeSynergiesSlowTopicsDown) {
+    StudyProblem plan(new StudyState({{"Algebra", 80.0}, {"Graphs", 2.0}}, 4.0), {}, {{"Algebra", -3.0}, {"Graphs", -5.0}});
+    EXPECT_DOUBLE_EQ(plan.synergy(0), -3.0);
+    SuccessorBuffer<StudyState> out;
+    plan.expand(plan.initial(), out);
+    ASSERT_EQ(out.size(), 2);
+    EXPECT_EQ(out[0].state.mastery[0], 8700);
+    // 2% + 10% - 5% = 7%
+    EXPECT_EQ(out[1].state.mastery[1], 700);
+
+    // Algebra stalls at 97%, where its capped gain of 3% is cancelled out
+    StudyProblem stalled(new StudyState({{"Algebra", 80.0}}, 20.0), {}, {{"Algebra", -3.0}});
+    AStar<StudyProblem> search(stalled);
+    EXPECT_EQ(search.search(), NO_NODE);
+
+    StudyProblem drained(new StudyState({{"Algebra", 1.0}}, 4.0), {}, {{"Algebra", -20.0}});
+    out.clear();
+    drained.expand(drained.initial(), out);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].state.mastery[0], 0);
+}
+
+TEST(TaskScheduler, MaskStatesScaleToHundredsOfTasks) {
+    std::vector<Task> tasks;
+    int total_priority = 0;
+    for (int i = 0; i < 200; i++) {
+        tasks.emplace_back("Task " + std::to_string(i + 1), 1 + i % 7, i);
+        total_priority += 1 + i % 7;
+    }
+    TaskScheduler scheduler(tasks);
+    TaskSchedulerState initial = scheduler.initial();
+    ASSERT_EQ(initial.words(), 4);
+    EXPECT_EQ(initial.pending_count(), 200);
+    EXPECT_EQ(scheduler.h(initial), total_priority);
+    std::uint64_t key;
+    EXPECT_FALSE(scheduler.pack(initial, key));
+
+    TaskSchedulerState later = initial;
+    later.complete(3);
+    later.complete(150);
+    EXPECT_FALSE(later.pending(150));
+    EXPECT_EQ(scheduler.h(later), total_priority - tasks[3].priority - tasks[150].priority);
+    EXPECT_FALSE(later == initial);
+    EXPECT_NE(later.hash(), initial.hash());
+
+    AStar<TaskScheduler> search(scheduler);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, 200);
+    EXPECT_TRUE(search.nodes()[goal].state.done());
+
+    TaskScheduler small;
+    ASSERT_TRUE(small.pack(small.initial(), key));
+    EXPECT_EQ(key, 0b111u);
+}
+
+TEST(Search, LegacyActionsAdapter) {
+    // Problems overriding actions() run through the default expand(), which interns the action names
+    TestProblem problem;
+    BreadthFirstSearch search(&problem);
+    auto node = search.search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->action->name, "Increment");
+    EXPECT_EQ(node->action->cost, 1);
+    EXPECT_EQ(problem.action_table.size(), 1);
+
+    // Typed problems still answer the old actions() call
+    VacuumCleaner vacuum;
+    auto actions = vacuum.actions(std::shared_ptr<State>(std::shared_ptr<State>(), vacuum.initial_state()));
+    ASSERT_EQ(actions.size(), 1);
+    EXPECT_EQ(actions[0]->name, "Suck");
+}
+
+// Overrides neither actions() nor expand()
+class NoActionsProblem : public Problem {
+public:
+    NoActionsProblem() { initial_state_ = new TestState(0); }
+    bool goal_test(State *) override { return false; }
+    double heuristic(State *) override { return 0; }
+};
+
+TEST(Search, ProblemWithoutActionsThrows) {
+    NoActionsProblem problem;
+    BreadthFirstSearch search(&problem);
+    EXPECT_THROW(search.search(), std::logic_error);
+    auto state = std::shared_ptr<State>(std::shared_ptr<State>(), problem.initial_state());
+    EXPECT_THROW(problem.actions(state), std::logic_error);
+    // The guard is released after the throw
+    EXPECT_THROW(problem.actions(state), std::logic_error);
+}
+
+TEST(Maze, GoalComesFromGrid) {
+    MazeProblem problem;
+    EXPECT_EQ(problem.grid->goal_x, 2);
+    EXPECT_EQ(problem.grid->goal_y, 2);
+    EXPECT_EQ(problem.h(MazeState(2, 2)), 0);
+    AStar<MazeProblem> search(problem);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, 8);
+}
+
+TEST(Maze, LoadsMovingAIMap) {
+    std::string path = testing::TempDir() + "symphony_test.map";
+    {
+        std::ofstream map(path);
+        map << "type octile\nheight 3\nwidth 4\nmap\n"
+            << "....\n"
+            << ".@@.\n"
+            << "..T.\n";
+    }
+    auto grid = std::make_shared<MazeGrid>(MazeGrid::load_movingai(path));
+    std::remove(path.c_str());
+    EXPECT_EQ(grid->rows, 3);
+    EXPECT_EQ(grid->cols, 4);
+    EXPECT_FALSE(grid->passable(1, 1));
+    EXPECT_FALSE(grid->passable(2, 2));
+    grid->set_goal(2, 3);
+
+    MazeProblem problem(grid, 2, 0);
+    BFS<MazeProblem> search(problem);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, 7);
+}
+
+TEST(Maze, LargeGridStatesStayCompact) {
+    static_assert(sizeof(MazeState) <= 16);
+    auto grid = std::make_shared<MazeGrid>(512, 512);
+    grid->set_goal(511, 511);
+    MazeProblem problem(grid, 0, 0);
+    AStar<MazeProblem> search(problem);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, 1022);
+}
+
+TEST(Frontier, FrontiersPopLowestF) {
+    BinaryHeapFrontier binary;
+    IndexedHeapFrontier indexed;
+    BucketFrontier bucket;
+    double fs[] = {5, 3, 8, 1, 4, 4, 9, 2};
+    for (std::uint32_t i = 0; i < 8; i++) {
+        binary.push(i, i, fs[i], 0);
+        indexed.push(i, i, fs[i], 0);
+        bucket.push(i, i, fs[i], 0);
+    }
+    double last_binary = 0, last_indexed = 0, last_bucket = 0;
+    while (!binary.empty()) {
+        double f_binary = fs[binary.pop()], f_indexed = fs[indexed.pop()], f_bucket = fs[bucket.pop()];
+        EXPECT_GE(f_binary, last_binary);
+        EXPECT_GE(f_indexed, last_indexed);
+        EXPECT_GE(f_bucket, last_bucket);
+        last_binary = f_binary, last_indexed = f_indexed, last_bucket = f_bucket;
+    }
+    EXPECT_TRUE(indexed.empty());
+    EXPECT_TRUE(bucket.empty());
+}
+
+TEST(Frontier, FrontiersBreakTiesOnLowerH) {
+    BinaryHeapFrontier binary;
+    IndexedHeapFrontier indexed;
+    BucketFrontier bucket;
+    double hs[] = {3, 0, 5, 1, 2};
+    for (std::uint32_t i = 0; i < 5; i++) {
+        binary.push(i, i, 6, hs[i]);
+        indexed.push(i, i, 6, hs[i]);
+        bucket.push(i, i, 6, hs[i]);
+    }
+    bucket.push(5, 5, 4, 4);
+    EXPECT_EQ(bucket.pop(), 5);
+    for (double h : {0, 1, 2, 3, 5}) {
+        EXPECT_EQ(hs[binary.pop()], h);
+        EXPECT_EQ(hs[indexed.pop()], h);
+        EXPECT_EQ(hs[bucket.pop()], h);
+    }
+    EXPECT_TRUE(bucket.empty());
+}
+
+TEST(Frontier, IndexedHeapDecreasesKey) {
+    IndexedHeapFrontier frontier;
+    frontier.push(10, 0, 7, 0);
+    frontier.push(11, 1, 5, 0);
+    frontier.push(12, 0, 3, 0); // cheaper path to slot 0 replaces node 10
+    EXPECT_EQ(frontier.size(), 2);
+    EXPECT_EQ(frontier.pop(), 12);
+    EXPECT_EQ(frontier.pop(), 11);
+    EXPECT_TRUE(frontier.empty());
+}
+
+TEST(Frontier, AStarFrontiersAgree) {
+    auto grid = std::make_shared<MazeGrid>(64, 64);
+    for (int x = 1; x < 63; x += 4) {
+        for (int y = 0; y < 60; y++) {
+            grid->set(x, (x / 4) % 2 ? y + 4 : y, MazeGrid::WALL);
+        }
+    }
+    grid->set_goal(63, 63);
+    MazeProblem problem(grid, 0, 0);
+    AStar<MazeProblem> search(problem);
+    EXPECT_EQ(search.resolved_frontier(), FrontierKind::BUCKET);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    double cost = search.nodes()[goal].path_cost;
+    for (auto kind : {FrontierKind::BINARY_HEAP, FrontierKind::INDEXED_HEAP}) {
+        AStar<MazeProblem> other(problem, kind);
+        goal = other.search();
+        ASSERT_NE(goal, NO_NODE);
+        EXPECT_EQ(other.nodes()[goal].path_cost, cost);
+    }
+
+    // Virtual problems without the declaration fall back to the indexed heap
+    TestProblem test_problem;
+    VirtualProblem adapter(&test_problem);
+    EXPECT_EQ(AStar<VirtualProblem>(adapter).resolved_frontier(), FrontierKind::INDEXED_HEAP);
+}
+
+TEST(Search, UniformCostSearchFindsCheapestPath) {
+    WeightedGraphProblem problem;
+    Search *search = create_search(SearchAlgorithmIndex::UNIFORM_COST_SEARCH, &problem);
+    ASSERT_NE(search, nullptr);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_DOUBLE_EQ(node->path_cost, 3.75); // A->B->C->D, not the direct A->D edge
+    EXPECT_EQ(node->action->name, "C->D");
+    delete search;
+
+    // BFS returns the shallowest, more expensive path
+    BreadthFirstSearch bfs(&problem);
+    EXPECT_DOUBLE_EQ(bfs.search()->path_cost, 7.0);
+}
+
+// Grid with per-cell entry costs, used to check uniform-cost search against Bellman-Ford.
+struct WeightedGrid {
+    using state_type = int;
+    int size = 12;
+    std::vector<double> cost;
+    bool integral = false;
+
+    int initial() const { return 0; }
+    bool is_goal(int cell) const { return cell == size * size - 1; }
+    double h(int) const { return 0; }
+    std::size_t hash(int cell) const { return cell; }
+    bool equal(int a, int b) const { return a == b; }
+    bool integral_costs() const { return integral; }
+    void expand(int cell, SuccessorBuffer<int> &out) const {
+        int x = cell / size, y = cell % size;
+        if (x > 0) out.emplace(0, cost[cell - size], cell - size);
+        if (x + 1 < size) out.emplace(1, cost[cell + size], cell + size);
+        if (y > 0) out.emplace(2, cost[cell - 1], cell - 1);
+        if (y + 1 < size) out.emplace(3, cost[cell + 1], cell + 1);
+    }
+};
+
+TEST(Search, UniformCostOptimalOnWeightedGrid) {
+    WeightedGrid grid;
+    unsigned seed = 7;
+    for (int i = 0; i < grid.size * grid.size; i++) {
+        seed = seed * 1103515245 + 12345;
+        grid.cost.push_back(1 + (seed >> 16) % 9);
+    }
+    // Reference distances by Bellman-Ford relaxation
+    std::vector<double> dist(grid.cost.size(), 1e18);
+    dist[0] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int cell = 0; cell < grid.size * grid.size; cell++) {
+            SuccessorBuffer<int> out;
+            grid.expand(cell, out);
+            for (auto &successor : out) {
+                if (dist[cell] + successor.cost < dist[successor.state]) {
+                    dist[successor.state] = dist[cell] + successor.cost;
+                    changed = true;
+                }
+            }
+        }
+    }
+    for (bool integral : {false, true}) {
+        grid.integral = integral;
+        for (auto kind : {FrontierKind::AUTO, FrontierKind::BINARY_HEAP, FrontierKind::INDEXED_HEAP}) {
+            UniformCost<WeightedGrid> search(grid, kind);
+            NodeId goal = search.search();
+            ASSERT_NE(goal, NO_NODE);
+            EXPECT_DOUBLE_EQ(search.nodes()[goal].path_cost, dist.back());
+        }
+    }
+}
+
+// Wide, shallow problem: every layer has many children, most of them reaching the same few states.
+struct WideProblem {
+    using state_type = int;
+    int initial() const { return 0; }
+    bool is_goal(int state) const { return state == 40; }
+    double h(int state) const { return 40 - state; }
+    std::size_t hash(int state) const { return state; }
+    bool equal(int a, int b) const { return a == b; }
+    void expand(int state, SuccessorBuffer<int> &out) const {
+        for (ActionId i = 0; i < 50; i++) {
+            if (state + 1 + i % 3 <= 40) {
+                out.emplace(i, 1 + i % 5, state + 1 + i % 3);
+            }
+        }
+    }
+};
+
+TEST(Beam, ModesReachGoal) {
+    WideProblem problem;
+    for (bool deduplicate : {false, true}) {
+        for (bool bounded : {false, true}) {
+            Beam<WideProblem> beam(problem, 8, deduplicate, bounded);
+            NodeId goal = beam.search();
+            ASSERT_NE(goal, NO_NODE);
+            EXPECT_EQ(beam.nodes()[goal].state, 40);
+            // Only kept candidates become nodes: at most beam_width per layer plus the root
+            EXPECT_LE(beam.nodes().size(), 1 + 8 * 40);
+        }
+    }
+}
+
+TEST(Beam, SelectionMatchesFullSort) {
+    WideProblem problem;
+    Beam<WideProblem> selected(problem, 5);
+    Beam<WideProblem> bounded(problem, 5, false, true);
+    NodeId a = selected.search();
+    NodeId b = bounded.search();
+    ASSERT_NE(a, NO_NODE);
+    ASSERT_NE(b, NO_NODE);
+    EXPECT_EQ(selected.nodes()[a].path_cost, bounded.nodes()[b].path_cost);
+}
+
+TEST(Beam, DeduplicationKeepsDistinctStates) {
+    WideProblem problem;
+    Beam<WideProblem> plain(problem, 8);
+    Beam<WideProblem> deduplicated(problem, 8, true);
+    ASSERT_NE(plain.search(), NO_NODE);
+    ASSERT_NE(deduplicated.search(), NO_NODE);
+    // A layer only ever reaches three distinct states, so deduplication keeps at most three of the eight slots
+    EXPECT_LE(deduplicated.nodes().size(), 1 + 3 * 40);
+    EXPECT_LT(deduplicated.nodes().size(), plain.nodes().size());
+}
+
+TEST(Search, BeamWidthFromConfig) {
+    TestProblem problem;
+    SearchConfig config;
+    config.beam_width = 7;
+    config.beam_deduplicate = true;
+    Search *search = create_search(SearchAlgorithmIndex::BEAM_SEARCH, &problem, config);
+    EXPECT_EQ(static_cast<BeamSearch *>(search)->beam_width, 7);
+    ASSERT_NE(search->search(), nullptr);
+    delete search;
+}
+
+// Maze that counts expansions from any thread, used to compare the serial and parallel engines.
+struct CountingMaze {
+    using state_type = MazeState;
+    const MazeProblem &maze;
+    mutable std::atomic<std::size_t> expanded{0};
+
+    MazeState initial() const { return maze.initial(); }
+    bool is_goal(const MazeState &state) const { return maze.is_goal(state); }
+    double h(const MazeState &state) const { return maze.h(state); }
+    std::size_t hash(const MazeState &state) const { return maze.hash(state); }
+    bool equal(const MazeState &a, const MazeState &b) const { return maze.equal(a, b); }
+    bool integral_costs() const { return true; }
+    void expand(const MazeState &state, SuccessorBuffer<MazeState> &out) const {
+        expanded++;
+        maze.expand(state, out);
+    }
+    MazeState goal() const { return maze.goal(); }
+    double h_reverse(const MazeState &state) const { return maze.h_reverse(state); }
+    void predecessors(const MazeState &state, SuccessorBuffer<MazeState> &out) const {
+        expanded++;
+        maze.predecessors(state, out);
+    }
+};
+
+static std::shared_ptr<MazeGrid> random_maze(int size, double walls, unsigned seed) {
+    auto grid = std::make_shared<MazeGrid>(size, size);
+    std::mt19937 random(seed);
+    std::bernoulli_distribution wall(walls);
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            if (wall(random)) {
+                grid->set(x, y, MazeGrid::WALL);
+            }
+        }
+    }
+    grid->set(0, 0, MazeGrid::FREE);
+    grid->set_goal(size - 1, size - 1);
+    return grid;
+}
+
+TEST(Parallel, MatchesSerialCostOnLargeMaze) {
+    auto grid = random_maze(300, 0.25, 7);
+    MazeProblem maze(grid, 0, 0);
+
+    CountingMaze serial_problem{maze};
+    auto start = std::chrono::steady_clock::now();
+    AStar<CountingMaze> serial(serial_problem);
+    NodeId serial_goal = serial.search();
+    auto serial_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_NE(serial_goal, NO_NODE);
+    double cost = serial.nodes()[serial_goal].path_cost;
+    RecordProperty("serial_expansions", std::to_string(serial_problem.expanded.load()));
+    RecordProperty("serial_seconds", std::to_string(serial_time));
+
+    for (unsigned threads : {1u, 2u, 4u}) {
+        CountingMaze problem{maze};
+        start = std::chrono::steady_clock::now();
+        ParallelAStar<CountingMaze> search(problem, threads);
+        NodeId goal = search.search();
+        auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ASSERT_NE(goal, NO_NODE);
+        EXPECT_EQ(search.nodes()[goal].path_cost, cost);
+        EXPECT_EQ(search.worker_count(), threads);
+        auto path = search.path(goal);
+        EXPECT_EQ(path.front()->state, MazeState(0, 0));
+        EXPECT_EQ(path.size(), static_cast<std::size_t>(cost) + 1);
+        std::size_t expanded = 0;
+        for (std::size_t count : search.worker_expansions()) {
+            expanded += count;
+        }
+        EXPECT_EQ(expanded, problem.expanded.load());
+        RecordProperty("expansions_" + std::to_string(threads), std::to_string(expanded));
+        RecordProperty("seconds_" + std::to_string(threads), std::to_string(time));
+    }
+}
+
+TEST(Parallel, TerminatesWithoutSolution) {
+    auto grid = random_maze(64, 0.2, 3);
+    grid->set(62, 63, MazeGrid::WALL);
+    grid->set(63, 62, MazeGrid::WALL);
+    grid->set(62, 62, MazeGrid::WALL);
+    MazeProblem maze(grid, 0, 0);
+    for (unsigned threads : {1u, 3u}) {
+        ParallelAStar<MazeProblem> search(maze, threads);
+        EXPECT_EQ(search.search(), NO_NODE);
+    }
+}
+
+TEST(Search, ParallelAStarFindsCheapestPath) {
+    WeightedGraphProblem problem;
+    SearchConfig config;
+    config.threads = 3;
+    Search *search = create_search(SearchAlgorithmIndex::PARALLEL_A_STAR, &problem, config);
+    ASSERT_NE(search, nullptr);
+    EXPECT_EQ(static_cast<ParallelAStarSearch *>(search)->threads, 3u);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_DOUBLE_EQ(node->path_cost, 3.75);
+    EXPECT_EQ(node->action->name, "C->D");
+    delete search;
+}
+
+TEST(VisitedSet, ConcurrentClaimsKeepLowestRank) {
+    WeightedGrid problem;
+    ConcurrentVisitedSet<WeightedGrid> visited(problem);
+    std::vector<std::thread> threads;
+    for (std::uint64_t t = 0; t < 4; t++) {
+        threads.emplace_back([&visited, t] {
+            for (int cell = 0; cell < 1000; cell++) {
+                visited.claim(cell, (3 - t) * 1000 + cell);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(visited.size(), 1000);
+    for (int cell = 0; cell < 1000; cell++) {
+        EXPECT_TRUE(visited.claimed_by(cell, cell)); // Thread 3 holds the lowest ranks
+    }
+    EXPECT_FALSE(visited.claim(5, 6));
+    EXPECT_TRUE(visited.claim(5, 4));
+}
+
+TEST(Parallel, BreadthFirstMatchesSerial) {
+    auto grid = random_maze(200, 0.25, 11);
+    // Two goal cells at the same depth: both engines must pick the same one
+    grid->set(199, 199, MazeGrid::WALL);
+    grid->set(199, 197, MazeGrid::GOAL);
+    grid->set(197, 199, MazeGrid::GOAL);
+    MazeProblem maze(grid, 0, 0);
+
+    BFS<MazeProblem> serial(maze);
+    NodeId serial_goal = serial.search();
+    ASSERT_NE(serial_goal, NO_NODE);
+    const MazeState &expected = serial.nodes()[serial_goal].state;
+
+    for (unsigned threads : {1u, 2u, 4u, 4u}) {
+        ParallelBFS<MazeProblem> search(maze, threads);
+        NodeId goal = search.search();
+        ASSERT_NE(goal, NO_NODE);
+        EXPECT_EQ(goal, serial_goal);
+        EXPECT_EQ(search.nodes()[goal].state, expected);
+        EXPECT_EQ(search.nodes()[goal].path_cost, serial.nodes()[serial_goal].path_cost);
+    }
+}
+
+// WideProblem whose expansion fails once a layer is deep enough.
+struct FailingWideProblem : WideProblem {
+    void expand(int state, SuccessorBuffer<int> &out) const {
+        if (state == 3) {
+            throw std::runtime_error("expansion failed");
+        }
+        WideProblem::expand(state, out);
+    }
+};
+
+TEST(Parallel, BreadthFirstRethrowsWorkerExceptions) {
+    FailingWideProblem problem;
+    for (unsigned threads : {1u, 3u}) {
+        ParallelBFS<FailingWideProblem> search(problem, threads, false);
+        EXPECT_THROW(search.search(), std::runtime_error);
+    }
+}
+
+TEST(Search, ParallelBreadthFirstFromConfig) {
+    TaskScheduler problem;
+    SearchConfig config;
+    config.bfs_threads = 3;
+    Search *search = create_search(SearchAlgorithmIndex::BREADTH_FIRST_SEARCH, &problem, config);
+    EXPECT_EQ(static_cast<BreadthFirstSearch *>(search)->threads, 3u);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, 3);
+    delete search;
+}
+
+// Checks that a path is a sequence of unit moves from the start to the goal.
+static void expect_maze_path(const std::vector<const EngineNode<MazeState> *> &path, const MazeProblem &maze) {
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(path.front()->state, maze.initial());
+    EXPECT_TRUE(maze.is_goal(path.back()->state));
+    for (std::size_t i = 1; i < path.size(); i++) {
+        const MazeState &from = path[i - 1]->state;
+        const MazeState &to = path[i]->state;
+        EXPECT_EQ(std::abs(from.x - to.x) + std::abs(from.y - to.y), 1);
+        EXPECT_TRUE(maze.grid->passable(to.x, to.y));
+        EXPECT_EQ(path[i]->path_cost, static_cast<double>(i));
+        MazeState moved = from;
+        switch (path[i]->action) {
+            case MazeProblem::UP: moved.x--; break;
+            case MazeProblem::DOWN: moved.x++; break;
+            case MazeProblem::LEFT: moved.y--; break;
+            default: moved.y++; break;
+        }
+        EXPECT_EQ(moved, to);
+    }
+}
+
+TEST(Bidirectional, MatchesAStarOnLargeMaze) {
+    auto grid = random_maze(400, 0.25, 5);
+    MazeProblem maze(grid, 0, 0);
+
+    auto timed = [](auto &&run) {
+        auto start = std::chrono::steady_clock::now();
+        NodeId goal = run();
+        return std::make_pair(goal, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+
+    CountingMaze astar_problem{maze};
+    AStar<CountingMaze> astar(astar_problem);
+    auto [astar_goal, astar_time] = timed([&] { return astar.search(); });
+    ASSERT_NE(astar_goal, NO_NODE);
+    double cost = astar.nodes()[astar_goal].path_cost;
+
+    CountingMaze bfs_problem{maze};
+    BFS<CountingMaze> bfs(bfs_problem);
+    auto [bfs_goal, bfs_time] = timed([&] { return bfs.search(); });
+    ASSERT_NE(bfs_goal, NO_NODE);
+    EXPECT_EQ(bfs.nodes()[bfs_goal].path_cost, cost);
+
+    for (bool use_heuristic : {true, false}) {
+        CountingMaze problem{maze};
+        Bidirectional<CountingMaze> search(problem, use_heuristic);
+        auto [goal, time] = timed([&] { return search.search(); });
+        ASSERT_NE(goal, NO_NODE);
+        EXPECT_EQ(search.nodes()[goal].path_cost, cost);
+        EXPECT_EQ(search.expansions(), problem.expanded.load());
+        expect_maze_path(search.path(goal), maze);
+        std::string name = use_heuristic ? "bidirectional_astar" : "bidirectional_dijkstra";
+        RecordProperty(name + "_expansions", std::to_string(search.expansions()));
+        RecordProperty(name + "_seconds", std::to_string(time));
+    }
+    // Meeting in the middle explores far less than a unidirectional blind search
+    CountingMaze dijkstra_problem{maze};
+    Bidirectional<CountingMaze> dijkstra(dijkstra_problem, false);
+    dijkstra.search();
+    EXPECT_LT(dijkstra.expansions(), bfs_problem.expanded.load());
+
+    RecordProperty("astar_expansions", std::to_string(astar_problem.expanded.load()));
+    RecordProperty("astar_seconds", std::to_string(astar_time));
+    RecordProperty("bfs_expansions", std::to_string(bfs_problem.expanded.load()));
+    RecordProperty("bfs_seconds", std::to_string(bfs_time));
+}
+
+TEST(Bidirectional, HandlesTrivialAndUnsolvable) {
+    auto grid = std::make_shared<MazeGrid>(8, 8);
+    grid->set_goal(3, 3);
+    MazeProblem at_goal(grid, 3, 3);
+    Bidirectional<MazeProblem> trivial(at_goal);
+    NodeId goal = trivial.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(trivial.nodes()[goal].path_cost, 0);
+
+    for (int y = 0; y < 8; y++) {
+        grid->set(5, y, MazeGrid::WALL);
+    }
+    MazeProblem walled(grid, 7, 7);
+    Bidirectional<MazeProblem> blocked(walled);
+    EXPECT_EQ(blocked.search(), NO_NODE);
+}
+
+TEST(Search, BidirectionalSearchSplicesActions) {
+    MazeProblem problem;
+    Search *search = create_search(SearchAlgorithmIndex::BIDIRECTIONAL_SEARCH, &problem);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, 8);
+    // The only way into the goal cell is from its right
+    EXPECT_EQ(node->action->name, "Left");
+    EXPECT_EQ(static_cast<const MazeState &>(*node->state), MazeState(2, 2));
+    delete search;
+
+    TestProblem legacy;
+    BidirectionalSearch unsupported(&legacy);
+    EXPECT_THROW(unsupported.search(), std::logic_error);
+}
+
+TEST(IDAStar, MatchesAStarCost) {
+    auto grid = random_maze(14, 0.2, 4);
+    MazeProblem maze(grid, 0, 0);
+    AStar<MazeProblem> astar(maze);
+    NodeId expected = astar.search();
+    ASSERT_NE(expected, NO_NODE);
+    double cost = astar.nodes()[expected].path_cost;
+
+    IDAStar<MazeProblem> plain(maze);
+    NodeId goal = plain.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(plain.nodes()[goal].path_cost, cost);
+    expect_maze_path(plain.path(goal), maze);
+    // Only the solution path is kept
+    EXPECT_EQ(plain.nodes().size(), static_cast<std::size_t>(cost) + 1);
+
+    IDAStar<MazeProblem> with_table(maze, 4096);
+    goal = with_table.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(with_table.nodes()[goal].path_cost, cost);
+    EXPECT_LT(with_table.expansions(), plain.expansions());
+
+    TaskScheduler scheduler;
+    AStar<TaskScheduler> scheduler_astar(scheduler);
+    IDAStar<TaskScheduler> scheduler_ida(scheduler);
+    NodeId a = scheduler_astar.search();
+    NodeId b = scheduler_ida.search();
+    ASSERT_NE(a, NO_NODE);
+    ASSERT_NE(b, NO_NODE);
+    EXPECT_EQ(scheduler_ida.nodes()[b].path_cost, scheduler_astar.nodes()[a].path_cost);
+}
+
+TEST(IDAStar, RaisesBoundToSmallestExceedingF) {
+    WeightedGraphProblem problem;
+    VirtualProblem adapter(&problem);
+    IDAStar<VirtualProblem> search(adapter);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_DOUBLE_EQ(search.nodes()[goal].path_cost, 3.75);
+    EXPECT_GT(search.iterations(), 1);
+
+    MazeProblem walled(random_maze(4, 0.0, 1), 0, 0);
+    for (int y = 0; y < 4; y++) {
+        walled.grid->set(2, y, MazeGrid::WALL);
+    }
+    IDAStar<MazeProblem> unsolvable(walled, 256);
+    EXPECT_EQ(unsolvable.search(), NO_NODE);
+}
+
+TEST(Search, IDAStarFromConfig) {
+    WeightedGraphProblem problem;
+    SearchConfig config;
+    config.ida_transposition_entries = 64;
+    Search *search = create_search(SearchAlgorithmIndex::IDA_STAR, &problem, config);
+    EXPECT_EQ(static_cast<IDAStarSearch *>(search)->transposition_entries, 64);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_DOUBLE_EQ(node->path_cost, 3.75);
+    EXPECT_EQ(node->action->name, "C->D");
+    delete search;
+}
+
+TEST(MemoryBounded, OptimalWithinBudget) {
+    auto grid = random_maze(40, 0.2, 4);
+    MazeProblem maze(grid, 0, 0);
+    AStar<MazeProblem> astar(maze);
+    NodeId expected = astar.search();
+    ASSERT_NE(expected, NO_NODE);
+    double cost = astar.nodes()[expected].path_cost;
+
+    using Engine = MemoryBoundedAStar<MazeProblem>;
+    // Ample memory behaves like A*; a tight budget forces dropping and regenerating nodes but still fits the optimal path
+    for (std::size_t nodes : {std::size_t(100000), std::size_t(cost) * 3}) {
+        Engine search(maze, nodes * Engine::node_bytes());
+        NodeId goal = search.search();
+        ASSERT_NE(goal, NO_NODE);
+        EXPECT_EQ(search.nodes()[goal].path_cost, cost);
+        EXPECT_FALSE(search.best_effort());
+        EXPECT_LE(search.peak_nodes(), nodes);
+        EXPECT_LE(search.peak_memory(), nodes * Engine::node_bytes());
+        expect_maze_path(search.path(goal), maze);
+    }
+}
+
+TEST(MemoryBounded, ReportsBestEffortWhenPathDoesNotFit) {
+    using Engine = MemoryBoundedAStar<MazeProblem>;
+    // A corridor whose goal is 19 steps away: every path is cut off at the depth 10 nodes allow
+    auto corridor = std::make_shared<MazeGrid>(1, 20);
+    corridor->set_goal(0, 19);
+    MazeProblem narrow(corridor, 0, 0);
+    Engine cut(narrow, 10 * Engine::node_bytes());
+    EXPECT_EQ(cut.search(), NO_NODE);
+    EXPECT_TRUE(cut.best_effort());
+    EXPECT_LE(cut.peak_nodes(), 10);
+
+    // An open grid keeps regenerating subtrees of equal f, so the expansion limit ends the search
+    auto grid = std::make_shared<MazeGrid>(10, 10);
+    grid->set_goal(9, 9);
+    MazeProblem maze(grid, 0, 0);
+    Engine limited(maze, 10 * Engine::node_bytes(), 20000);
+    EXPECT_EQ(limited.search(), NO_NODE);
+    EXPECT_TRUE(limited.best_effort());
+    EXPECT_EQ(limited.expansions(), 20000);
+    EXPECT_LE(limited.peak_nodes(), 10);
+}
+
+TEST(Search, MemoryBoundedFromConfig) {
+    WeightedGraphProblem problem;
+    SearchConfig config;
+    config.memory_budget = 1 << 16;
+    Search *search = create_search(SearchAlgorithmIndex::MEMORY_BOUNDED_A_STAR, &problem, config);
+    auto *bounded = static_cast<MemoryBoundedAStarSearch *>(search);
+    EXPECT_EQ(bounded->memory_budget, 1 << 16);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_DOUBLE_EQ(node->path_cost, 3.75);
+    EXPECT_FALSE(bounded->best_effort);
+    delete search;
+}
+
+TEST(AnytimeAStar, ImprovesToOptimal) {
+    auto grid = random_maze(60, 0.3, 5);
+    MazeProblem maze(grid, 0, 0);
+    AStar<MazeProblem> astar(maze);
+    NodeId expected = astar.search();
+    ASSERT_NE(expected, NO_NODE);
+    double cost = astar.nodes()[expected].path_cost;
+
+    AnytimeAStar<MazeProblem> anytime(maze, 3.0, 0.5);
+    std::vector<AnytimeSolution> solutions;
+    anytime.on_solution = [&](const AnytimeSolution &solution) {
+        expect_maze_path(anytime.path(solution.goal), maze);
+        solutions.push_back(solution);
+    };
+    NodeId goal = anytime.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(anytime.nodes()[goal].path_cost, cost);
+    EXPECT_EQ(anytime.suboptimality_bound(), 1.0);
+    EXPECT_FALSE(anytime.interrupted());
+
+    // Every report improves on the last one and keeps its promise
+    ASSERT_FALSE(solutions.empty());
+    EXPECT_EQ(solutions.front().weight, 3.0);
+    EXPECT_EQ(solutions.back().cost, cost);
+    EXPECT_EQ(solutions.back().bound, 1.0);
+    for (std::size_t i = 0; i < solutions.size(); i++) {
+        EXPECT_LE(solutions[i].cost, solutions[i].bound * cost);
+        EXPECT_LE(solutions[i].bound, solutions[i].weight);
+        if (i > 0) {
+            EXPECT_LE(solutions[i].cost, solutions[i - 1].cost);
+            EXPECT_LE(solutions[i].bound, solutions[i - 1].bound);
+            EXPECT_TRUE(solutions[i].cost < solutions[i - 1].cost || solutions[i].bound < solutions[i - 1].bound);
+            EXPECT_GE(solutions[i].expanded, solutions[i - 1].expanded);
+        }
+    }
+    // On this maze the inflated first iteration settles for a longer path
+    EXPECT_GT(solutions.front().cost, cost);
+    EXPECT_GT(solutions.size(), 1u);
+}
+
+TEST(AnytimeAStar, LimitsReturnBestSoFar) {
+    auto grid = random_maze(60, 0.3, 5);
+    MazeProblem maze(grid, 0, 0);
+    AnytimeAStar<MazeProblem> first(maze, 3.0, 0.5);
+    std::uint64_t first_expansions = 0;
+    first.on_solution = [&](const AnytimeSolution &solution) {
+        if (first_expansions == 0) {
+            first_expansions = solution.expanded;
+        }
+    };
+    ASSERT_NE(first.search(), NO_NODE);
+    ASSERT_GT(first_expansions, 0u);
+
+    // Stopping right after the first solution keeps it, with the bound it was reported with
+    AnytimeAStar<MazeProblem> limited(maze, 3.0, 0.5);
+    limited.limits.expansions = first_expansions + 1;
+    NodeId goal = limited.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_LE(limited.expansions(), first_expansions + 1);
+    if (limited.interrupted()) {
+        EXPECT_GE(limited.suboptimality_bound(), 1.0);
+        EXPECT_LE(limited.suboptimality_bound(), 3.0);
+    }
+    expect_maze_path(limited.path(goal), maze);
+
+    // Stopping before any solution returns none
+    AnytimeAStar<MazeProblem> starved(maze, 3.0, 0.5);
+    starved.limits.expansions = 1;
+    EXPECT_EQ(starved.search(), NO_NODE);
+    EXPECT_TRUE(starved.interrupted());
+
+    // A time limit that has already passed stops at the first check
+    AnytimeAStar<MazeProblem> late(maze, 3.0, 0.5);
+    late.limits.seconds = 1e-9;
+    EXPECT_EQ(late.search(), NO_NODE);
+    EXPECT_TRUE(late.interrupted());
+    EXPECT_EQ(late.expansions(), 0u);
+}
+
+TEST(Search, AnytimeAStarFromConfig) {
+    WeightedGraphProblem problem;
+    SearchConfig config;
+    config.anytime_initial_weight = 4.0;
+    config.anytime_weight_step = 1.0;
+    Search *search = create_search(SearchAlgorithmIndex::ANYTIME_A_STAR, &problem, config);
+    auto *anytime = static_cast<AnytimeAStarSearch *>(search);
+    EXPECT_EQ(anytime->initial_weight, 4.0);
+    std::vector<double> costs;
+    anytime->on_solution = [&costs](std::shared_ptr<Node> solution, double bound) {
+        ASSERT_NE(solution, nullptr);
+        EXPECT_GE(bound, 1.0);
+        costs.push_back(solution->path_cost);
+    };
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_DOUBLE_EQ(node->path_cost, 3.75);
+    EXPECT_EQ(node->action->name, "C->D");
+    ASSERT_FALSE(costs.empty());
+    EXPECT_DOUBLE_EQ(costs.back(), 3.75);
+    EXPECT_EQ(anytime->suboptimality_bound, 1.0);
+    EXPECT_FALSE(anytime->interrupted);
+    delete search;
+}
+
+// Cost of an optimal path found from scratch, or -1 if the goal is cut off
+static double fresh_cost(const MazeProblem &maze) {
+    AStar<MazeProblem> astar(maze);
+    NodeId goal = astar.search();
+    return goal == NO_NODE ? -1.0 : astar.nodes()[goal].path_cost;
+}
+
+TEST(DStarLite, MatchesAStarAcrossEdits) {
+    // Small dense mazes make closed cells cut through the kept distances often
+    for (unsigned seed = 0; seed < 60; seed++) {
+        std::mt19937 random(seed);
+        int size = std::uniform_int_distribution<int>(6, 20)(random);
+        auto grid = random_maze(size, 0.3, seed);
+        MazeProblem maze(grid, 0, 0);
+        DStarLite<MazeProblem> planner(maze);
+        std::uniform_int_distribution<int> coordinate(0, size - 1);
+        std::uniform_int_distribution<int> edits(1, 6);
+        for (int round = 0; round < 40; round++) {
+            NodeId goal = planner.search();
+            double expected = fresh_cost(maze);
+            ASSERT_EQ(goal == NO_NODE ? -1.0 : planner.nodes()[goal].path_cost, expected) << "seed " << seed << ", round " << round;
+            if (goal != NO_NODE) {
+                expect_maze_path(planner.path(goal), maze);
+                // Every few rounds the agent moves a few steps along its plan
+                if (round % 5 == 4) {
+                    auto path = planner.path(goal);
+                    const MazeState &next = path[std::min<std::size_t>(3, path.size() - 1)]->state;
+                    maze.set_start(next.x, next.y);
+                }
+            }
+            std::vector<MazeState> toggled;
+            for (int edit = edits(random); edit > 0; edit--) {
+                int x = coordinate(random);
+                int y = coordinate(random);
+                const MazeState &start = maze.initial();
+                if (grid->at(x, y) == MazeGrid::GOAL || (x == start.x && y == start.y)) {
+                    continue;
+                }
+                grid->set(x, y, grid->at(x, y) == MazeGrid::WALL ? MazeGrid::FREE : MazeGrid::WALL);
+                toggled.emplace_back(x, y);
+            }
+            // Odd seeds report the cells one at a time, even ones as a batch
+            if (seed % 2) {
+                for (const MazeState &cell : toggled) {
+                    planner.changed(cell);
+                }
+            } else {
+                planner.changed(std::span<const MazeState>(toggled));
+            }
+        }
+    }
+}
+
+TEST(DStarLite, RepairsLocally) {
+    auto grid = random_maze(200, 0.2, 9);
+    MazeProblem maze(grid, 0, 0);
+    DStarLite<MazeProblem> planner(maze);
+    NodeId goal = planner.search();
+    ASSERT_NE(goal, NO_NODE);
+    std::uint64_t initial_work = planner.stats().expanded;
+    std::size_t kept = planner.size();
+
+    // Nothing changed: only the path is walked again
+    goal = planner.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_LE(planner.stats().expanded, planner.stats().solution_depth + 1);
+    EXPECT_EQ(planner.size(), kept);
+
+    // Block a cell in the middle of the path and replan
+    auto path = planner.path(goal);
+    const MazeState &blocked = path[path.size() / 2]->state;
+    grid->set(blocked.x, blocked.y, MazeGrid::WALL);
+    planner.changed(blocked);
+    goal = planner.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(planner.nodes()[goal].path_cost, fresh_cost(maze));
+    expect_maze_path(planner.path(goal), maze);
+    if (STATS_ENABLED) {
+        EXPECT_LT(planner.stats().expanded, initial_work / 2);
+    }
+}
+
+TEST(Search, DStarLiteFromConfig) {
+    auto grid = random_maze(30, 0.2, 10);
+    MazeProblem maze(grid, 0, 0);
+    Search *search = create_search(SearchAlgorithmIndex::D_STAR_LITE, &maze);
+    auto *planner = static_cast<DStarLiteSearch *>(search);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, fresh_cost(maze));
+
+    // Wall off the cell the path enters first
+    Node *second = node.get();
+    while (second->parent && second->parent->parent) {
+        second = second->parent.get();
+    }
+    const auto &cell = static_cast<const MazeState &>(*second->state);
+    grid->set(cell.x, cell.y, MazeGrid::WALL);
+    planner->changed(std::make_shared<MazeState>(cell.x, cell.y));
+    node = search->search();
+    double expected = fresh_cost(maze);
+    if (expected < 0) {
+        EXPECT_EQ(node, nullptr);
+    } else {
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->path_cost, expected);
+    }
+    delete search;
+}
+
+TEST(Stats, CountsAStarWork) {
+    if (!STATS_ENABLED) {
+        GTEST_SKIP() << "Statistics are compiled out";
+    }
+    auto grid = random_maze(60, 0.2, 7);
+    MazeProblem maze(grid, 0, 0);
+    CountingMaze problem{maze};
+    AStar<CountingMaze> search(problem);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+
+    const SearchStats &stats = search.stats();
+    EXPECT_EQ(stats.expanded, problem.expanded.load());
+    EXPECT_GE(stats.generated, stats.expanded);
+    EXPECT_GT(stats.duplicates, 0u);
+    EXPECT_GT(stats.heuristic_calls, 0u);
+    EXPECT_GT(stats.peak_frontier, 0u);
+    EXPECT_EQ(stats.peak_nodes, search.nodes().size());
+    EXPECT_GE(stats.peak_memory, search.nodes().memory_usage());
+    EXPECT_TRUE(stats.solved);
+    EXPECT_EQ(stats.solution_cost, search.nodes()[goal].path_cost);
+    EXPECT_EQ(stats.solution_depth, search.path(goal).size() - 1);
+    EXPECT_GT(stats.branching_factor(), 1.0);
+    EXPECT_EQ(stats.expand_seconds, 0.0);
+
+    // Parallel workers' counters add up
+    CountingMaze parallel_problem{maze};
+    ParallelAStar<CountingMaze> parallel(parallel_problem, 3);
+    ASSERT_NE(parallel.search(), NO_NODE);
+    EXPECT_EQ(parallel.stats().expanded, parallel_problem.expanded.load());
+    EXPECT_EQ(parallel.stats().solution_cost, stats.solution_cost);
+}
+
+TEST(Stats, BranchingFactorSolvesUniformTree) {
+    SearchStats stats;
+    stats.solved = true;
+    stats.solution_depth = 3;
+    stats.generated = 2 + 4 + 8;
+    EXPECT_NEAR(stats.branching_factor(), 2.0, 1e-6);
+    stats.solved = false;
+    EXPECT_EQ(stats.branching_factor(), 0.0);
+}
+
+TEST(Stats, DumpsJsonAndCsv) {
+    SearchStats stats;
+    stats.expanded = 12;
+    stats.generated = 30;
+    stats.solved = true;
+    stats.solution_depth = 2;
+    stats.solution_cost = 2.5;
+    std::string json = stats.to_json();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"expanded\":12,"), std::string::npos);
+    EXPECT_NE(json.find("\"solved\":true"), std::string::npos);
+    EXPECT_NE(json.find("\"solution_cost\":2.5"), std::string::npos);
+
+    std::string header = SearchStats::csv_header();
+    std::string row = stats.to_csv();
+    EXPECT_EQ(std::count(header.begin(), header.end(), ','), std::count(row.begin(), row.end(), ','));
+    EXPECT_EQ(row.substr(0, 6), "12,30,");
+}
+
+TEST(Search, StatsAndPhaseTimersFromConfig) {
+    MazeProblem maze(random_maze(14, 0.2, 4), 0, 0);
+    SearchConfig config;
+    config.phase_timers = true;
+    for (auto algorithm : {SearchAlgorithmIndex::BREADTH_FIRST_SEARCH, SearchAlgorithmIndex::A_STAR, SearchAlgorithmIndex::BIDIRECTIONAL_SEARCH,
+                           SearchAlgorithmIndex::IDA_STAR}) {
+        Search *search = create_search(algorithm, &maze, config);
+        EXPECT_TRUE(search->phase_timers);
+        std::shared_ptr<Node> node = search->search();
+        ASSERT_NE(node, nullptr);
+        EXPECT_TRUE(search->stats.solved);
+        EXPECT_EQ(search->stats.solution_cost, node->path_cost);
+        EXPECT_GT(search->stats.search_seconds, 0.0);
+        if (STATS_ENABLED) {
+            EXPECT_GT(search->stats.expanded, 0u);
+            EXPECT_GT(search->stats.expand_seconds, 0.0);
+            EXPECT_LE(search->stats.expand_seconds, search->stats.search_seconds);
+        }
+        delete search;
+    }
+}
+
+// Large maze whose goal is walled off, so every engine has to exhaust it.
+static MazeProblem unsolvable_maze(int size) {
+    auto grid = random_maze(size, 0.2, 9);
+    grid->set(size - 2, size - 1, MazeGrid::WALL);
+    grid->set(size - 1, size - 2, MazeGrid::WALL);
+    grid->set(size - 2, size - 2, MazeGrid::WALL);
+    return MazeProblem(grid, 0, 0);
+}
+
+template <class Engine>
+static void expect_node_limit(Engine &&engine) {
+    engine.limits.expansions = 10;
+    EXPECT_EQ(engine.search(), NO_NODE);
+    EXPECT_EQ(engine.stats().status, SearchStatus::NODE_LIMIT);
+    EXPECT_FALSE(engine.stats().solved);
+    if (STATS_ENABLED) {
+        EXPECT_LE(engine.stats().expanded, 2 * 10u);
+    }
+    // Lifting the limit solves it
+    engine.limits.expansions = 0;
+    EXPECT_NE(engine.search(), NO_NODE);
+    EXPECT_EQ(engine.stats().status, SearchStatus::SOLVED);
+}
+
+TEST(SearchLimits, NodeLimitStopsEveryEngine) {
+    MazeProblem maze(random_maze(40, 0.2, 4), 0, 0);
+    expect_node_limit(AStar<MazeProblem>(maze));
+    expect_node_limit(BFS<MazeProblem>(maze));
+    expect_node_limit(Beam<MazeProblem>(maze, 50));
+    expect_node_limit(Bidirectional<MazeProblem>(maze));
+    expect_node_limit(IDAStar<MazeProblem>(maze, 1 << 12));
+    expect_node_limit(MemoryBoundedAStar<MazeProblem>(maze, std::size_t(1) << 20));
+    expect_node_limit(AnytimeAStar<MazeProblem>(maze));
+    expect_node_limit(DStarLite<MazeProblem>(maze));
+
+    MazeProblem blocked = unsolvable_maze(20);
+    AStar<MazeProblem> exhausted(blocked);
+    EXPECT_EQ(exhausted.search(), NO_NODE);
+    EXPECT_EQ(exhausted.stats().status, SearchStatus::NO_SOLUTION);
+}
+
+TEST(SearchLimits, TimeAndMemoryLimits) {
+    MazeProblem maze = unsolvable_maze(1000);
+    AStar<MazeProblem> timed(maze);
+    timed.limits.seconds = 0.01;
+    EXPECT_EQ(timed.search(), NO_NODE);
+    EXPECT_EQ(timed.stats().status, SearchStatus::TIME_LIMIT);
+    EXPECT_LT(timed.stats().search_seconds, 1.0);
+
+    AStar<MazeProblem> bounded(maze);
+    bounded.limits.memory = std::size_t(4) << 20;
+    EXPECT_EQ(bounded.search(), NO_NODE);
+    EXPECT_EQ(bounded.stats().status, SearchStatus::MEMORY_LIMIT);
+    EXPECT_LT(bounded.nodes().memory_usage(), std::size_t(8) << 20);
+
+    // Memory and peaks come from what the engines hold, so they do not depend on SYMPHONY_STATS
+    MazeProblem small(random_maze(40, 0.2, 4), 0, 0);
+    IDAStar<MazeProblem> deepening(small, 1 << 12);
+    ASSERT_NE(deepening.search(), NO_NODE);
+    EXPECT_GE(deepening.stats().peak_nodes, deepening.stats().solution_depth);
+    EXPECT_GT(deepening.stats().peak_memory, 0u);
+    DStarLite<MazeProblem> planner(small);
+    ASSERT_NE(planner.search(), NO_NODE);
+    EXPECT_GT(planner.stats().peak_memory, planner.size() * (sizeof(MazeState) + sizeof(FrontierEntry)));
+}
+
+TEST(SearchLimits, CancelsAsyncSearchAfterProgress) {
+    MazeProblem maze = unsolvable_maze(1000);
+    AStar<MazeProblem> engine(maze);
+    std::atomic<int> reports{0};
+    engine.limits.progress_seconds = 0.001;
+    engine.limits.progress = [&reports](const SearchProgress &progress) {
+        EXPECT_GT(progress.expanded, 0u);
+        EXPECT_GT(progress.memory, 0u);
+        reports++;
+    };
+    CancellationToken cancel = engine.limits.cancel;
+    std::future<NodeId> goal = search_async(engine);
+    while (reports == 0 && goal.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    }
+    cancel.cancel();
+    EXPECT_EQ(goal.get(), NO_NODE);
+    EXPECT_EQ(engine.stats().status, SearchStatus::CANCELLED);
+    EXPECT_GT(reports.load(), 0);
+    EXPECT_NE(engine.stats().to_json().find("\"status\":\"cancelled\""), std::string::npos);
+}
+
+TEST(SearchLimits, StopsParallelEngines) {
+    MazeProblem maze(random_maze(40, 0.2, 4), 0, 0);
+    expect_node_limit(ParallelAStar<MazeProblem>(maze, 4));
+    ParallelBFS<MazeProblem> layered(maze, 4);
+    layered.limits.expansions = 10;
+    EXPECT_EQ(layered.search(), NO_NODE);
+    EXPECT_EQ(layered.stats().status, SearchStatus::NODE_LIMIT);
+    layered.limits.expansions = 0;
+    EXPECT_NE(layered.search(), NO_NODE);
+
+    MazeProblem blocked = unsolvable_maze(1000);
+    ParallelBFS<MazeProblem> timed(blocked, 4);
+    timed.limits.seconds = 0.01;
+    EXPECT_EQ(timed.search(), NO_NODE);
+    EXPECT_EQ(timed.stats().status, SearchStatus::TIME_LIMIT);
+    EXPECT_LT(timed.stats().search_seconds, 1.0);
+
+    ParallelAStar<MazeProblem> bounded(blocked, 4);
+    bounded.limits.memory = std::size_t(4) << 20;
+    EXPECT_EQ(bounded.search(), NO_NODE);
+    EXPECT_EQ(bounded.stats().status, SearchStatus::MEMORY_LIMIT);
+
+    SearchConfig config;
+    config.threads = 4;
+    Search *search = create_search(SearchAlgorithmIndex::PARALLEL_A_STAR, &blocked, config);
+    std::atomic<int> reports{0};
+    search->limits.progress_seconds = 0.001;
+    search->limits.progress = [&reports](const SearchProgress &) { reports++; };
+    CancellationToken cancel = search->limits.cancel;
+    std::future<std::shared_ptr<Node>> node = search->search_async();
+    while (reports == 0 && node.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    }
+    cancel.cancel();
+    EXPECT_EQ(node.get(), nullptr);
+    EXPECT_EQ(search->stats.status, SearchStatus::CANCELLED);
+    delete search;
+}
+
+TEST(SearchLimits, DStarLiteResumesAfterLimit) {
+    auto grid = random_maze(60, 0.25, 6);
+    MazeProblem maze(grid, 0, 0);
+    double expected = fresh_cost(maze);
+    ASSERT_GE(expected, 0.0);
+    DStarLite<MazeProblem> planner(maze);
+    planner.limits.expansions = 100;
+    EXPECT_EQ(planner.search(), NO_NODE);
+    EXPECT_EQ(planner.stats().status, SearchStatus::NODE_LIMIT);
+    std::size_t kept = planner.size();
+    EXPECT_GT(kept, 0u);
+    planner.limits.expansions = 0;
+    NodeId goal = planner.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(planner.nodes()[goal].path_cost, expected);
+    EXPECT_GE(planner.size(), kept);
+}
+
+TEST(Search, LimitsFromConfig) {
+    MazeProblem maze(random_maze(40, 0.2, 4), 0, 0);
+    SearchConfig config;
+    config.node_limit = 5;
+    Search *search = create_search(SearchAlgorithmIndex::A_STAR, &maze, config);
+    EXPECT_EQ(search->limits.expansions, 5u);
+    std::future<std::shared_ptr<Node>> node = search->search_async();
+    EXPECT_EQ(node.get(), nullptr);
+    EXPECT_EQ(search->stats.status, SearchStatus::NODE_LIMIT);
+    search->limits.expansions = 0;
+    EXPECT_NE(search->search(), nullptr);
+    EXPECT_EQ(search->stats.status, SearchStatus::SOLVED);
+    delete search;
+
+    MazeProblem blocked = unsolvable_maze(1000);
+    config.node_limit = 0;
+    config.time_limit = 0.01;
+    search = create_search(SearchAlgorithmIndex::IDA_STAR, &blocked, config);
+    EXPECT_EQ(search->search(), nullptr);
+    EXPECT_EQ(search->stats.status, SearchStatus::TIME_LIMIT);
+    delete search;
+}
+
+TEST(WorkStealingPool, RunsEveryIndexOnce) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    std::vector<std::atomic<int>> calls(1000);
+    for (int round = 0; round < 3; round++) {
+        pool.run(calls.size(), [&](unsigned worker, std::size_t index) {
+            EXPECT_LT(worker, pool.size());
+            calls[index]++;
+            if (index < 10) {
+                // A few slow tasks at the front of worker 0's block leave its remaining work to the others
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    for (const auto &count : calls) {
+        EXPECT_EQ(count.load(), 3);
+    }
+    EXPECT_GT(pool.steals(), 0u);
+
+    EXPECT_THROW(pool.run(100, [](unsigned, std::size_t index) {
+        if (index == 42) {
+            throw std::runtime_error("instance failed");
+        }
+    }), std::runtime_error);
+    std::atomic<std::size_t> after{0};
+    pool.run(50, [&after](unsigned, std::size_t) { after++; });
+    EXPECT_EQ(after.load(), 50u);
+}
+
+TEST(Batch, MatchesSerialSearchesInInputOrder) {
+    std::vector<std::unique_ptr<MazeProblem>> mazes;
+    std::vector<const MazeProblem *> problems;
+    for (unsigned seed = 0; seed < 40; seed++) {
+        mazes.push_back(std::make_unique<MazeProblem>(random_maze(10 + static_cast<int>(seed % 7) * 8, 0.3, seed), 0, 0));
+        problems.push_back(mazes.back().get());
+    }
+    WorkStealingPool pool(3);
+    auto report = solve_batch<MazeProblem>(pool, problems, [](const auto &slot) { return AStar(slot); });
+    ASSERT_EQ(report.results.size(), problems.size());
+    std::size_t solved = 0;
+    std::uint64_t expanded = 0;
+    for (std::size_t i = 0; i < problems.size(); i++) {
+        AStar<MazeProblem> serial(*problems[i]);
+        NodeId goal = serial.search();
+        const auto &result = report.results[i];
+        EXPECT_EQ(result.stats.solved, goal != NO_NODE);
+        if (goal != NO_NODE) {
+            solved++;
+            EXPECT_EQ(result.stats.solution_cost, serial.stats().solution_cost);
+            ASSERT_EQ(result.solution.size(), serial.path(goal).size());
+            EXPECT_EQ(result.solution.front(), problems[i]->initial());
+            EXPECT_TRUE(problems[i]->is_goal(result.solution.back()));
+        } else {
+            EXPECT_TRUE(result.solution.empty());
+        }
+        expanded += result.stats.expanded;
+    }
+    EXPECT_GT(solved, 0u);
+    EXPECT_LT(solved, problems.size());
+    EXPECT_EQ(report.summary.instances, problems.size());
+    EXPECT_EQ(report.summary.solved, solved);
+    EXPECT_EQ(report.summary.expanded, expanded);
+    EXPECT_EQ(report.summary.threads, 3u);
+    EXPECT_GT(report.summary.instances_per_second(), 0.0);
+
+    // Reused breadth-first engines reset their visited sets between instances
+    auto depths = solve_batch<MazeProblem>(pool, problems, [](const auto &slot) { return BFS(slot); },
+                                           [](const auto &engine, NodeId goal, const MazeProblem &) {
+                                               return goal == NO_NODE ? -1.0 : engine.nodes()[goal].path_cost;
+                                           });
+    for (std::size_t i = 0; i < problems.size(); i++) {
+        EXPECT_EQ(depths.results[i].solution, report.results[i].stats.solved ? report.results[i].stats.solution_cost : -1.0);
+    }
+}
+
+TEST(Search, SolveBatchFromConfig) {
+    std::vector<std::unique_ptr<MazeProblem>> mazes;
+    std::vector<Problem *> problems;
+    for (unsigned seed = 0; seed < 12; seed++) {
+        mazes.push_back(std::make_unique<MazeProblem>(random_maze(24, 0.25, seed + 100), 0, 0));
+        problems.push_back(mazes.back().get());
+    }
+    WorkStealingPool pool(2);
+    for (auto algorithm : {SearchAlgorithmIndex::A_STAR, SearchAlgorithmIndex::BREADTH_FIRST_SEARCH, SearchAlgorithmIndex::UNIFORM_COST_SEARCH,
+                           SearchAlgorithmIndex::BIDIRECTIONAL_SEARCH}) {
+        auto report = solve_batch(problems, algorithm, SearchConfig(), pool);
+        ASSERT_EQ(report.results.size(), problems.size());
+        for (std::size_t i = 0; i < problems.size(); i++) {
+            Search *search = create_search(algorithm, problems[i]);
+            std::shared_ptr<Node> expected = search->search();
+            std::shared_ptr<Node> node = report.results[i].solution;
+            ASSERT_EQ(node == nullptr, expected == nullptr);
+            if (node) {
+                EXPECT_EQ(node->path_cost, expected->path_cost);
+                EXPECT_EQ(node->state->hash(), expected->state->hash());
+                EXPECT_EQ(report.results[i].stats.solution_depth, search->stats.solution_depth);
+            }
+            delete search;
+        }
+    }
+
+    SearchConfig config;
+    config.node_limit = 3;
+    auto limited = solve_batch(problems, SearchAlgorithmIndex::A_STAR, config, pool);
+    for (const auto &result : limited.results) {
+        EXPECT_EQ(result.solution, nullptr);
+        EXPECT_EQ(result.stats.status, SearchStatus::NODE_LIMIT);
+    }
+    EXPECT_EQ(limited.summary.solved, 0u);
+    EXPECT_THROW(solve_batch(problems, SearchAlgorithmIndex::PARALLEL_A_STAR, config, pool), std::invalid_argument);
+}
+
+// Grid walk that counts heuristic evaluations.
+struct CountedWalk : GridWalk {
+    mutable std::atomic<int> evaluations{0};
+    double h(const Cell &cell) const {
+        evaluations++;
+        return GridWalk::h(cell);
+    }
+};
+
+TEST(Engine, HeuristicEvaluatedLazily) {
+    CountedWalk walk;
+    walk.size = 12;
+    BFS<CountedWalk> bfs(walk);
+    ASSERT_NE(bfs.search(), NO_NODE);
+    ParallelBFS<CountedWalk> parallel_bfs(walk, 3);
+    ASSERT_NE(parallel_bfs.search(), NO_NODE);
+    EXPECT_EQ(walk.evaluations, 0);
+
+    // A* keeps each state's h in its best-g table, so reopening a state does not evaluate it again
+    AStar<CountedWalk> astar(walk);
+    ASSERT_NE(astar.search(), NO_NODE);
+    EXPECT_LE(walk.evaluations, walk.size * walk.size);
+}
+
+TEST(HeuristicCache, EvictionPolicies) {
+    for (CacheEviction eviction : {CacheEviction::LRU, CacheEviction::CLOCK}) {
+        CountedWalk walk;
+        CachedHeuristic<CountedWalk> cached(walk, 2, eviction);
+        GridWalk::Cell a{0, 0}, b{1, 0}, c{2, 0};
+        for (const auto &cell : {a, b, a, c}) {
+            cached.h(cell);
+        }
+        // c replaced b, the entry not used since it was stored
+        EXPECT_EQ(walk.evaluations, 3);
+        EXPECT_EQ(cached.h(a), walk.GridWalk::h(a));
+        EXPECT_EQ(walk.evaluations, 3);
+        cached.h(b);
+        cached.h(c);
+        EXPECT_EQ(walk.evaluations, 5);
+        EXPECT_EQ(cached.heuristic_cache_hits(), 2u);
+        EXPECT_EQ(cached.heuristic_cache_misses(), 5u);
+        EXPECT_EQ(cached.size(), 2u);
+    }
+}
+
+TEST(HeuristicCache, IDAStarReusesValuesAcrossIterations) {
+    MazeProblem maze(random_maze(14, 0.2, 4), 0, 0);
+    AStar<MazeProblem> reference(maze);
+    NodeId expected = reference.search();
+    ASSERT_NE(expected, NO_NODE);
+
+    CachedHeuristic<MazeProblem> cached(maze, 1 << 12);
+    IDAStar<CachedHeuristic<MazeProblem>> search(cached);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, reference.nodes()[expected].path_cost);
+    EXPECT_GT(search.stats().heuristic_cache_hits, 0u);
+    EXPECT_EQ(search.stats().heuristic_cache_hits, cached.heuristic_cache_hits());
+    EXPECT_EQ(search.stats().heuristic_cache_misses, cached.heuristic_cache_misses());
+    EXPECT_GT(search.stats().heuristic_cache_hit_rate(), 0.5);
+
+    // A second search reports only its own lookups
+    ASSERT_NE(search.search(), NO_NODE);
+    EXPECT_EQ(search.stats().heuristic_cache_misses, 0u);
+}
+
+TEST(Search, HeuristicCacheFromConfig) {
+    MazeProblem maze(random_maze(14, 0.2, 4), 0, 0);
+    SearchConfig config;
+    config.heuristic_cache_entries = 256;
+    config.heuristic_cache_eviction = CacheEviction::LRU;
+    for (auto algorithm : {SearchAlgorithmIndex::A_STAR, SearchAlgorithmIndex::IDA_STAR, SearchAlgorithmIndex::MEMORY_BOUNDED_A_STAR}) {
+        Search *search = create_search(algorithm, &maze, config);
+        EXPECT_EQ(search->heuristic_cache_entries, 256u);
+        std::shared_ptr<Node> node = search->search();
+        ASSERT_NE(node, nullptr);
+        EXPECT_GT(search->stats.heuristic_cache_misses, 0u);
+        if (STATS_ENABLED) {
+            EXPECT_EQ(search->stats.heuristic_cache_hits + search->stats.heuristic_cache_misses, search->stats.heuristic_calls);
+        }
+        delete search;
+    }
+}
+
+// Projection of a GridWalk onto one coordinate, walked one step at a time towards length - 1.
+struct WalkProjection {
+    int length;
+    bool column;
+
+    std::size_t size() const { return length; }
+    std::size_t rank(const GridWalk::Cell &cell) const { return column ? cell.y : cell.x; }
+    void goals(std::vector<std::size_t> &out) const { out.push_back(length - 1); }
+    void predecessors(std::size_t rank, std::vector<std::size_t> &out) const {
+        if (rank > 0) out.push_back(rank - 1);
+        if (rank + 1 < static_cast<std::size_t>(length)) out.push_back(rank + 1);
+    }
+};
+
+static_assert(AbstractionOf<WalkProjection, GridWalk::Cell>);
+static_assert(AbstractionOf<MazeBlockAbstraction, MazeState>);
+
+TEST(PatternDatabase, ProjectionsAddUpToManhattan) {
+    GridWalk walk;
+    walk.size = 12;
+    WalkProjection rows{walk.size, false};
+    WalkProjection columns{walk.size, true};
+    PatternDatabase built = PatternDatabase::build(rows);
+    EXPECT_EQ(built.bits(), 4u);
+    EXPECT_EQ(built.bytes(), 6u);
+    EXPECT_FALSE(built.mapped());
+
+    std::string path = testing::TempDir() + "symphony_rows.pdb";
+    built.save(path);
+    PatternDatabase loaded(path);
+    EXPECT_TRUE(loaded.mapped());
+    ASSERT_EQ(loaded.size(), built.size());
+    for (std::size_t rank = 0; rank < loaded.size(); rank++) {
+        EXPECT_EQ(loaded.distance(rank), walk.size - 1 - rank);
+    }
+    PatternDatabase column_table = PatternDatabase::build(columns);
+
+    // Every move changes one coordinate, so the two projections count disjoint moves and may be added
+    PatternHeuristic<GridWalk> heuristic(walk, PatternCombine::ADD, false);
+    heuristic.add(loaded, rows);
+    heuristic.add(column_table, columns);
+    for (int x = 0; x < walk.size; x++) {
+        for (int y = 0; y < walk.size; y++) {
+            EXPECT_EQ(heuristic.h({x, y}), walk.h({x, y}));
+        }
+    }
+    AStar<PatternHeuristic<GridWalk>> search(heuristic);
+    NodeId goal = search.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(search.nodes()[goal].path_cost, 2 * (walk.size - 1));
+    std::remove(path.c_str());
+}
+
+TEST(PatternDatabase, SaturatesLongDistances) {
+    WalkProjection line{40, false};
+    PatternDatabase wide = PatternDatabase::build(line);
+    EXPECT_EQ(wide.bits(), 8u);
+    EXPECT_EQ(wide.distance(0), 39u);
+
+    PatternDatabase narrow = PatternDatabase::build(line, 4);
+    EXPECT_EQ(narrow.bits(), 4u);
+    EXPECT_EQ(narrow.distance(0), narrow.max_distance());
+    EXPECT_EQ(narrow.distance(30), 9u);
+    EXPECT_EQ(narrow.distance(39), 0u);
+    EXPECT_THROW(PatternDatabase::build(line, 2), std::invalid_argument);
+}
+
+TEST(PatternDatabase, RejectsForeignFiles) {
+    std::string path = testing::TempDir() + "symphony_bad.pdb";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "definitely not a pattern database";
+    }
+    EXPECT_THROW(PatternDatabase{path}, std::runtime_error);
+
+    PatternDatabase::build(WalkProjection{10, false}).save(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_THROW(PatternDatabase{path}, std::runtime_error);
+    std::remove(path.c_str());
+
+    PatternDatabase table = PatternDatabase::build(WalkProjection{10, false});
+    GridWalk walk;
+    PatternHeuristic<GridWalk> heuristic(walk);
+    EXPECT_THROW(heuristic.add(table, WalkProjection{11, false}), std::invalid_argument);
+}
+
+TEST(PatternDatabase, MazeBlocksGuideAStar) {
+    auto grid = random_maze(60, 0.2, 7);
+    MazeProblem maze(grid, 0, 0);
+    CountingMaze plain_problem{maze};
+    AStar<CountingMaze> plain(plain_problem);
+    NodeId expected = plain.search();
+    ASSERT_NE(expected, NO_NODE);
+
+    MazeBlockAbstraction blocks(grid, 4);
+    PatternDatabase table = PatternDatabase::build(blocks);
+    EXPECT_EQ(table.size(), 15u * 15u);
+    CountingMaze guided_problem{maze};
+    PatternHeuristic<CountingMaze> heuristic(guided_problem);
+    heuristic.add(table, blocks);
+    AStar<PatternHeuristic<CountingMaze>> guided(heuristic);
+    NodeId goal = guided.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(guided.nodes()[goal].path_cost, plain.nodes()[expected].path_cost);
+    EXPECT_LE(guided_problem.expanded.load(), plain_problem.expanded.load());
+}
+
+TEST(HeuristicKernels, MatchScalarFallbacks) {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<std::int32_t> coordinate(-1000, 1000);
+    std::uniform_real_distribution<double> value(0.0, 100.0);
+    // Lengths around the vector widths exercise the remainder loops
+    for (std::size_t count : {0, 1, 3, 4, 7, 8, 9, 17, 64}) {
+        std::vector<std::int32_t> xs(count), ys(count);
+        std::vector<double> values(count);
+        for (std::size_t i = 0; i < count; i++) {
+            xs[i] = coordinate(random);
+            ys[i] = coordinate(random);
+            values[i] = value(random);
+        }
+        std::vector<double> fast(count), slow(count);
+        batch_manhattan(xs.data(), ys.data(), count, 17, -5, fast.data());
+        batch_manhattan_scalar(xs.data(), ys.data(), count, 17, -5, slow.data());
+        EXPECT_EQ(fast, slow) << heuristic_kernel_isa();
+        EXPECT_NEAR(array_sum(values.data(), count), array_sum_scalar(values.data(), count), 1e-9);
+    }
+}
+
+// Maze that counts h_batch calls and the single-state calls they replace.
+struct BatchCountingMaze : CountingMaze {
+    mutable std::atomic<std::size_t> batches{0};
+    mutable std::atomic<std::size_t> singles{0};
+    double h(const MazeState &state) const {
+        singles++;
+        return maze.h(state);
+    }
+    void h_batch(std::span<const Successor<MazeState>> successors, std::span<double> out) const {
+        batches++;
+        maze.h_batch(successors, out);
+    }
+};
+
+static_assert(BatchHeuristicProblem<MazeProblem>);
+static_assert(BatchHeuristicProblem<VirtualProblem>);
+static_assert(!BatchHeuristicProblem<CachedHeuristic<MazeProblem>>);
+
+TEST(Engine, BatchedHeuristicOncePerExpansion) {
+    auto grid = random_maze(40, 0.2, 7);
+    MazeProblem maze(grid, 0, 0);
+    AStar<MazeProblem> reference(maze);
+    NodeId expected = reference.search();
+    ASSERT_NE(expected, NO_NODE);
+    double cost = reference.nodes()[expected].path_cost;
+
+    BatchCountingMaze astar_problem{maze};
+    AStar<BatchCountingMaze> astar(astar_problem);
+    NodeId goal = astar.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(astar.nodes()[goal].path_cost, cost);
+    EXPECT_LE(astar_problem.batches.load(), astar_problem.expanded.load());
+    EXPECT_GT(astar_problem.batches.load(), 0u);
+    EXPECT_EQ(astar_problem.singles.load(), 1u);  // The root
+
+    BatchCountingMaze ida_problem{maze};
+    IDAStar<BatchCountingMaze> ida(ida_problem);
+    goal = ida.search();
+    ASSERT_NE(goal, NO_NODE);
+    EXPECT_EQ(ida.nodes()[goal].path_cost, cost);
+    EXPECT_EQ(ida_problem.batches.load(), ida_problem.expanded.load());
+
+    BatchCountingMaze beam_problem{maze};
+    Beam<BatchCountingMaze> beam(beam_problem, 16, true);
+    ASSERT_NE(beam.search(), NO_NODE);
+    EXPECT_EQ(beam_problem.batches.load(), beam_problem.expanded.load());
+
+    // The virtual path batches too, through Problem::heuristic_batch
+    Search *search = create_search(SearchAlgorithmIndex::A_STAR, &maze);
+    std::shared_ptr<Node> node = search->search();
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->path_cost, cost);
+    delete search;
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();